@@ -0,0 +1,77 @@
+//
+// CheckAuxDetHitShared: the histograms of CheckAuxDetHit, filled
+// concurrently by all the art schedules (see ScheduleHistograms.h).
+//
+// art Framework includes.
+#include "art/Framework/Core/SharedAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art_root_io/TFileService.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "lardataobj/Simulation/AuxDetHit.h"
+#include "larg4/Analysis/ScheduleHistograms.h"
+
+// Root includes.
+#include "TH1F.h"
+
+namespace larg4 {
+    class CheckAuxDetHitShared;
+}
+
+class larg4::CheckAuxDetHitShared : public art::SharedAnalyzer {
+public:
+  CheckAuxDetHitShared(fhicl::ParameterSet const& p, art::ProcessingFrame const&);
+
+private:
+  void beginJob(art::ProcessingFrame const&) override;
+  void analyze(const art::Event& event, art::ProcessingFrame const& frame) override;
+  void endJob(art::ProcessingFrame const&) override;
+
+  ScheduleHistograms _histograms;
+  std::size_t _hnHits{0};   // number of AuxDetHitHits
+  std::size_t _hEdep{0};    // average energy deposition in AuxDetHitHits
+  std::size_t _hID{0};      // AuxDet ID's
+  std::size_t _hexit{0};    // exit points in z
+  std::size_t _hentry{0};   // entry points in z
+};
+
+larg4::CheckAuxDetHitShared::CheckAuxDetHitShared(fhicl::ParameterSet const& p,
+                                                 art::ProcessingFrame const&) :
+  art::SharedAnalyzer(p)
+{
+  async<art::InEvent>();
+}
+
+void larg4::CheckAuxDetHitShared::beginJob(art::ProcessingFrame const&)
+{
+  art::ServiceHandle<art::TFileService const> tfs;
+  _hnHits = _histograms.make<TH1F>(*tfs, "hnHits", "Number of AuxDetHits", 30, 0,30 );
+  _hEdep = _histograms.make<TH1F>(*tfs, "hEdep", "Energy deposition in AuxDetHits", 100,0.,4.);
+  _hID = _histograms.make<TH1F>(*tfs, "hID", "Id of hit AuxDet", 100,0.,5.);
+  _hexit = _histograms.make<TH1F>(*tfs, "hexit", "exit points in z", 100,-100.,100.);
+  _hentry = _histograms.make<TH1F>(*tfs, "hentry", "entry points in z", 100,-100.,100.);
+} // end beginJob
+
+void larg4::CheckAuxDetHitShared::analyze(const art::Event& event, art::ProcessingFrame const& frame)
+{
+  art::ScheduleID const sid = frame.scheduleID();
+  std::vector<art::Handle<sim::AuxDetHitCollection>> allSims;
+  event.getManyByType(allSims);
+  for (auto const& sims : allSims) {
+    _histograms(sid, _hnHits).Fill(sims->size());
+    for (auto const& hit : *sims) {
+      _histograms(sid, _hEdep).Fill(hit.GetEnergyDeposited());
+      _histograms(sid, _hexit).Fill(hit.GetExitZ());
+      _histograms(sid, _hentry).Fill(hit.GetEntryZ());
+      _histograms(sid, _hID).Fill(hit.GetID());
+    }
+  }
+} // end analyze
+
+void larg4::CheckAuxDetHitShared::endJob(art::ProcessingFrame const&)
+{
+  _histograms.merge();
+}
+
+DEFINE_ART_MODULE(larg4::CheckAuxDetHitShared)
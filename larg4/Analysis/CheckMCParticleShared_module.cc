@@ -0,0 +1,62 @@
+//
+// CheckMCParticleShared: the histograms of CheckMCParticle, filled
+// concurrently by all the art schedules (see ScheduleHistograms.h).
+//
+// Framework includes.
+#include "art/Framework/Core/SharedAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art_root_io/TFileService.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "nusimdata/SimulationBase/MCParticle.h"
+#include "larg4/Analysis/ScheduleHistograms.h"
+
+// Root includes.
+#include "TH1F.h"
+
+namespace larg4 {
+  class CheckMCParticleShared;
+}
+
+class larg4::CheckMCParticleShared : public art::SharedAnalyzer {
+public:
+  CheckMCParticleShared(fhicl::ParameterSet const& p, art::ProcessingFrame const&);
+
+private:
+  void beginJob(art::ProcessingFrame const&) override;
+  void analyze(const art::Event& event, art::ProcessingFrame const& frame) override;
+  void endJob(art::ProcessingFrame const&) override;
+
+  ScheduleHistograms _histograms;
+  std::size_t _hnParts{0};
+};
+
+larg4::CheckMCParticleShared::CheckMCParticleShared(fhicl::ParameterSet const& p,
+                                                   art::ProcessingFrame const&) :
+  art::SharedAnalyzer(p)
+{
+  async<art::InEvent>();
+}
+
+void larg4::CheckMCParticleShared::beginJob(art::ProcessingFrame const&)
+{
+  art::ServiceHandle<art::TFileService const> tfs;
+  _hnParts = _histograms.make<TH1F>(*tfs, "hnParts", "Number of generated Particles", 100, 0., 2000.);
+} // end beginJob
+
+void larg4::CheckMCParticleShared::analyze(const art::Event& event, art::ProcessingFrame const& frame)
+{
+  std::vector<art::Handle<std::vector<simb::MCParticle>>> allGens;
+  event.getManyByType(allGens);
+  for (auto const& gens : allGens) {
+    _histograms(frame.scheduleID(), _hnParts).Fill(gens->size());
+  }
+} // end analyze
+
+void larg4::CheckMCParticleShared::endJob(art::ProcessingFrame const&)
+{
+  _histograms.merge();
+}
+
+DEFINE_ART_MODULE(larg4::CheckMCParticleShared)
@@ -0,0 +1,92 @@
+//
+// CheckSimEnergyDepositShared: the histograms of CheckSimEnergyDeposit,
+// filled concurrently by all the art schedules (see ScheduleHistograms.h).
+// The deposit dump of CheckSimEnergyDeposit is not available here.
+//
+// art Framework includes.
+#include "art/Framework/Core/SharedAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art_root_io/TFileService.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "larg4/Analysis/ScheduleHistograms.h"
+
+// Root includes.
+#include "TH1F.h"
+
+// STL includes.
+#include <cmath>
+
+namespace larg4 {
+    class CheckSimEnergyDepositShared;
+}
+
+class larg4::CheckSimEnergyDepositShared : public art::SharedAnalyzer {
+public:
+
+  CheckSimEnergyDepositShared(fhicl::ParameterSet const& p, art::ProcessingFrame const&);
+
+private:
+  void beginJob(art::ProcessingFrame const&) override;
+  void analyze(const art::Event& event, art::ProcessingFrame const& frame) override;
+  void endJob(art::ProcessingFrame const&) override;
+
+  ScheduleHistograms _histograms;
+  std::size_t _hnHits{0};         // number of SimEnergyDepositHits
+  std::size_t _hEdep{0};          // average energy deposition in SimEnergyDepositHits
+  std::size_t _hnumPhotons{0};    // number of Photons per SimEnergyDepositHits
+  std::size_t _hLandauPhotons{0}; // number of Photons/cm SimEnergyDepositHits
+  std::size_t _hLandauEdep{0};    // Edep/cm  SimEnergyDepositHits
+  std::size_t _hSteplength{0};    // Geant 4 step length
+};
+
+larg4::CheckSimEnergyDepositShared::CheckSimEnergyDepositShared(fhicl::ParameterSet const& p,
+                                                               art::ProcessingFrame const&) :
+  art::SharedAnalyzer(p)
+{
+  async<art::InEvent>();
+}
+
+void larg4::CheckSimEnergyDepositShared::beginJob(art::ProcessingFrame const&)
+{
+  art::ServiceHandle<art::TFileService const> tfs;
+  _hnHits = _histograms.make<TH1F>(*tfs, "hnHits", "Number of SimEnergyDeposits", 300, 0, 0);
+  _hEdep = _histograms.make<TH1F>(*tfs, "hEdep", "Energy deposition in SimEnergyDeposits", 100,0.,0.02);
+  _hnumPhotons = _histograms.make<TH1F>(*tfs, "hnumPhotons", "number of photons per  SimEnergyDeposit", 100,0.,500.);
+  _hLandauPhotons= _histograms.make<TH1F>(*tfs, "hLandauPhotons", "number of photons/cm", 100,0.,2000000.);
+  _hLandauEdep= _histograms.make<TH1F>(*tfs, "hLandauEdep", "Edep/cm", 100,0.,10.);
+  _hSteplength= _histograms.make<TH1F>(*tfs, "hSteplength", "geant 4 step length", 100,0.,0.05);
+} // end beginJob
+
+void larg4::CheckSimEnergyDepositShared::analyze(const art::Event& event, art::ProcessingFrame const& frame)
+{
+  art::ScheduleID const sid = frame.scheduleID();
+  std::vector<art::Handle<sim::SimEnergyDepositCollection>> allSims;
+  event.getManyByType(allSims);
+  for (auto const& sims : allSims) {
+    double sumPhotons=0.0;
+    double sumE = 0.0;
+    _histograms(sid, _hnHits).Fill(sims->size());
+    for (auto const& hit : *sims) {
+      // sum up energy deposit in a 1cm slice of liquid Argon.
+      if (std::abs(hit.EndZ())<0.5) {
+        sumPhotons= sumPhotons + hit.NumPhotons();
+        sumE= sumE +hit.Energy();
+      }
+      _histograms(sid, _hnumPhotons).Fill( hit.NumPhotons());
+      _histograms(sid, _hEdep).Fill( hit.Energy());   // energy deposit in MeV
+      _histograms(sid, _hSteplength).Fill( hit.StepLength()); // step length in cm
+    }
+    _histograms(sid, _hLandauPhotons).Fill(sumPhotons);
+    _histograms(sid, _hLandauEdep).Fill(sumE);
+  }
+} // end analyze
+
+void larg4::CheckSimEnergyDepositShared::endJob(art::ProcessingFrame const&)
+{
+  _histograms.merge();
+}
+
+DEFINE_ART_MODULE(larg4::CheckSimEnergyDepositShared)
@@ -11,9 +11,10 @@
 
 // Root includes.
 #include "TH1F.h"
-#include "TNtuple.h"
+#include "TTree.h"
 
 // STL includes.
+#include <algorithm>
 #include <cmath>
 
 // Other includes.
@@ -24,6 +25,15 @@ namespace larg4 {
     class CheckSimEnergyDeposit;
 }
 
+//
+// With the optional table
+//   Dump: { prescale: 1  basketSize: 1048576  autoFlush: -33554432 }
+// every prescale-th deposit is also written to the TTree "deposits", one
+// branch of basic type per field, for analysis with columnar readers
+// (RDataFrame, uproot) without running art. basketSize is the buffer size of
+// each branch in bytes, autoFlush the TTree::SetAutoFlush setting (a
+// negative value is a size in bytes).
+//
 class larg4::CheckSimEnergyDeposit : public art::EDAnalyzer {
 public:
 
@@ -39,11 +49,32 @@ private:
   TH1F* _hLandauPhotons{nullptr}; // Edep/cm  SimEnergyDepositHits
   TH1F* _hLandauEdep{nullptr};    // number of Photons/cm SimEnergyDepositHits
   TH1F* _hSteplength{nullptr};    // Geant 4 step length
-  TNtuple* _ntuple{nullptr};
+
+  // Deposit dump
+  struct Deposit_t {
+    UInt_t   run, subRun, event;
+    UShort_t collection;          // index of the collection in the event
+    Int_t    trackID, pdgCode;
+    Int_t    numPhotons, numFPhotons, numSPhotons;
+    Float_t  energy, stepLength;  // MeV, cm
+    Float_t  startX, startY, startZ, startT;
+    Float_t  endX, endY, endZ, endT;
+  };
+  bool const _dump;
+  unsigned long const _prescale;
+  Int_t const _basketSize;
+  Long64_t const _autoFlush;
+  unsigned long _nDeposits{0};
+  Deposit_t _deposit;
+  TTree* _tree{nullptr};
 };
 
 larg4::CheckSimEnergyDeposit::CheckSimEnergyDeposit(fhicl::ParameterSet const& p) :
-  art::EDAnalyzer(p)
+  art::EDAnalyzer(p),
+  _dump(p.has_key("Dump")),
+  _prescale(std::max(p.get<unsigned long>("Dump.prescale", 1), 1ul)),
+  _basketSize(p.get<Int_t>("Dump.basketSize", 1 << 20)),
+  _autoFlush(p.get<Long64_t>("Dump.autoFlush", -32 << 20))
 {}
 
 void larg4::CheckSimEnergyDeposit::beginJob()
@@ -55,14 +86,38 @@ void larg4::CheckSimEnergyDeposit::beginJob()
   _hLandauPhotons= tfs->make<TH1F>("hLandauPhotons", "number of photons/cm", 100,0.,2000000.);
   _hLandauEdep= tfs->make<TH1F>("hLandauEdep", "Edep/cm", 100,0.,10.);
   _hSteplength= tfs->make<TH1F>("hSteplength", "geant 4 step length", 100,0.,0.05);
-  _ntuple = tfs->make<TNtuple>("ntuple","Demo ntuple",
-                               "Event:Edep:em_Edep:nonem_Edep:xpos:ypos:zpos:time");
+  if (!_dump) return;
+  _tree = tfs->make<TTree>("deposits", "SimEnergyDeposits");
+  _tree->Branch("run", &_deposit.run, "run/i", _basketSize);
+  _tree->Branch("subRun", &_deposit.subRun, "subRun/i", _basketSize);
+  _tree->Branch("event", &_deposit.event, "event/i", _basketSize);
+  _tree->Branch("collection", &_deposit.collection, "collection/s", _basketSize);
+  _tree->Branch("trackID", &_deposit.trackID, "trackID/I", _basketSize);
+  _tree->Branch("pdgCode", &_deposit.pdgCode, "pdgCode/I", _basketSize);
+  _tree->Branch("numPhotons", &_deposit.numPhotons, "numPhotons/I", _basketSize);
+  _tree->Branch("numFPhotons", &_deposit.numFPhotons, "numFPhotons/I", _basketSize);
+  _tree->Branch("numSPhotons", &_deposit.numSPhotons, "numSPhotons/I", _basketSize);
+  _tree->Branch("energy", &_deposit.energy, "energy/F", _basketSize);
+  _tree->Branch("stepLength", &_deposit.stepLength, "stepLength/F", _basketSize);
+  _tree->Branch("startX", &_deposit.startX, "startX/F", _basketSize);
+  _tree->Branch("startY", &_deposit.startY, "startY/F", _basketSize);
+  _tree->Branch("startZ", &_deposit.startZ, "startZ/F", _basketSize);
+  _tree->Branch("startT", &_deposit.startT, "startT/F", _basketSize);
+  _tree->Branch("endX", &_deposit.endX, "endX/F", _basketSize);
+  _tree->Branch("endY", &_deposit.endY, "endY/F", _basketSize);
+  _tree->Branch("endZ", &_deposit.endZ, "endZ/F", _basketSize);
+  _tree->Branch("endT", &_deposit.endT, "endT/F", _basketSize);
+  _tree->SetAutoFlush(_autoFlush);
 } // end beginJob
 
 void larg4::CheckSimEnergyDeposit::analyze(const art::Event& event)
 {
   std::vector<art::Handle<sim::SimEnergyDepositCollection>> allSims;
   event.getManyByType(allSims);
+  _deposit.run = event.run();
+  _deposit.subRun = event.subRun();
+  _deposit.event = event.event();
+  _deposit.collection = 0;
   for (auto const& sims : allSims) {
     double sumPhotons=0.0;
     double sumE = 0.0;
@@ -76,19 +131,28 @@ void larg4::CheckSimEnergyDeposit::analyze(const art::Event& event)
       _hnumPhotons->Fill( hit.NumPhotons());
       _hEdep->Fill( hit.Energy());   // energy deposit in MeV
       _hSteplength->Fill( hit.StepLength()); // step length in cm
-      /*
-        _ntuple->Fill(event.event(),
-        hit.GetEdep(),
-        hit.GetEdepEM(),
-        hit.GetEdepnonEM(),
-        hit.GetXpos(),
-        hit.GetYpos(),
-        hit.GetZpos(),
-        hit.GetTime());
-      */
+      if (_tree && (_nDeposits++ % _prescale) == 0) {
+        _deposit.trackID = hit.TrackID();
+        _deposit.pdgCode = hit.PdgCode();
+        _deposit.numPhotons = hit.NumPhotons();
+        _deposit.numFPhotons = hit.NumFPhotons();
+        _deposit.numSPhotons = hit.NumSPhotons();
+        _deposit.energy = hit.Energy();
+        _deposit.stepLength = hit.StepLength();
+        _deposit.startX = hit.StartX();
+        _deposit.startY = hit.StartY();
+        _deposit.startZ = hit.StartZ();
+        _deposit.startT = hit.StartT();
+        _deposit.endX = hit.EndX();
+        _deposit.endY = hit.EndY();
+        _deposit.endZ = hit.EndZ();
+        _deposit.endT = hit.EndT();
+        _tree->Fill();
+      }
     }
     _hLandauPhotons->Fill(sumPhotons);
     _hLandauEdep->Fill(sumE);
+    ++_deposit.collection;
   }
 } // end analyze
 
@@ -0,0 +1,142 @@
+//
+// PhysicsSummary: a fixed set of summary distributions of the simulation
+// output, with fixed binning so that the histograms of two jobs can be
+// compared bin by bin with compareSummaries (see compareSummaries.cc):
+//
+//   hDepositEnergy      energy of the SimEnergyDeposits [MeV]
+//   hdEdx               dE/dx of the SimEnergyDeposits [MeV/cm]
+//   hStepLength         step length of the SimEnergyDeposits [cm]
+//   hDepositsPerEvent   number of SimEnergyDeposits per event
+//   hParticlesPerEvent  number of MCParticles per event
+//   hSpecies            MCParticles by species
+//   hAuxDetEnergy       energy of the AuxDetHits [MeV]
+//   hAuxDetHitsPerEvent number of AuxDetHits per event
+//
+// The products are read with getManyByType, as in the Check* modules.
+//
+// art Framework includes.
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art_root_io/TFileService.h"
+#include "art_root_io/TFileDirectory.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "lardataobj/Simulation/AuxDetHit.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "nusimdata/SimulationBase/MCParticle.h"
+
+// Root includes.
+#include "TH1D.h"
+
+// STL includes.
+#include <array>
+#include <cstdlib>
+
+namespace larg4 {
+  class PhysicsSummary;
+}
+
+class larg4::PhysicsSummary : public art::EDAnalyzer {
+public:
+  explicit PhysicsSummary(fhicl::ParameterSet const& p);
+
+private:
+  void beginJob() override;
+  void analyze(const art::Event& event) override;
+
+  double const _maxDepositEnergy;  // MeV
+  double const _maxdEdx;           // MeV/cm
+  double const _maxStepLength;     // cm
+  double const _maxDeposits;
+  double const _maxParticles;
+  double const _maxAuxDetEnergy;   // MeV
+  double const _maxAuxDetHits;
+
+  TH1D* _hDepositEnergy{nullptr};
+  TH1D* _hdEdx{nullptr};
+  TH1D* _hStepLength{nullptr};
+  TH1D* _hDepositsPerEvent{nullptr};
+  TH1D* _hParticlesPerEvent{nullptr};
+  TH1D* _hSpecies{nullptr};
+  TH1D* _hAuxDetEnergy{nullptr};
+  TH1D* _hAuxDetHitsPerEvent{nullptr};
+};
+
+namespace {
+  // species bins of hSpecies; the last bin collects everything else
+  std::array<std::pair<int, char const*>, 12> const species{{
+    {11, "e-"}, {-11, "e+"}, {22, "gamma"}, {13, "mu-"}, {-13, "mu+"},
+    {211, "pi+"}, {-211, "pi-"}, {111, "pi0"}, {2212, "p"}, {2112, "n"},
+    {0, "nuclei"}, {0, "other"}}};
+
+  int speciesBin(int pdg) {
+    for (std::size_t i = 0; i < species.size() - 2; ++i) {
+      if (species[i].first == pdg) return i;
+    }
+    return (std::abs(pdg) > 1000000000) ? species.size() - 2 : species.size() - 1;
+  }
+}
+
+larg4::PhysicsSummary::PhysicsSummary(fhicl::ParameterSet const& p) :
+  art::EDAnalyzer(p),
+  _maxDepositEnergy(p.get<double>("maxDepositEnergy", 0.02)),
+  _maxdEdx(p.get<double>("maxdEdx", 10.)),
+  _maxStepLength(p.get<double>("maxStepLength", 0.05)),
+  _maxDeposits(p.get<double>("maxDeposits", 100000.)),
+  _maxParticles(p.get<double>("maxParticles", 2000.)),
+  _maxAuxDetEnergy(p.get<double>("maxAuxDetEnergy", 4.)),
+  _maxAuxDetHits(p.get<double>("maxAuxDetHits", 30.))
+{}
+
+void larg4::PhysicsSummary::beginJob()
+{
+  art::ServiceHandle<art::TFileService const> tfs;
+  _hDepositEnergy = tfs->make<TH1D>("hDepositEnergy", "Energy of SimEnergyDeposits;E [MeV]", 100, 0., _maxDepositEnergy);
+  _hdEdx = tfs->make<TH1D>("hdEdx", "dE/dx of SimEnergyDeposits;dE/dx [MeV/cm]", 100, 0., _maxdEdx);
+  _hStepLength = tfs->make<TH1D>("hStepLength", "Step length of SimEnergyDeposits;step [cm]", 100, 0., _maxStepLength);
+  _hDepositsPerEvent = tfs->make<TH1D>("hDepositsPerEvent", "SimEnergyDeposits per event", 100, 0., _maxDeposits);
+  _hParticlesPerEvent = tfs->make<TH1D>("hParticlesPerEvent", "MCParticles per event", 100, 0., _maxParticles);
+  _hSpecies = tfs->make<TH1D>("hSpecies", "MCParticles by species", species.size(), 0., species.size());
+  for (std::size_t i = 0; i < species.size(); ++i) {
+    _hSpecies->GetXaxis()->SetBinLabel(i + 1, species[i].second);
+  }
+  _hAuxDetEnergy = tfs->make<TH1D>("hAuxDetEnergy", "Energy of AuxDetHits;E [MeV]", 100, 0., _maxAuxDetEnergy);
+  _hAuxDetHitsPerEvent = tfs->make<TH1D>("hAuxDetHitsPerEvent", "AuxDetHits per event", 100, 0., _maxAuxDetHits);
+} // end beginJob
+
+void larg4::PhysicsSummary::analyze(const art::Event& event)
+{
+  std::vector<art::Handle<sim::SimEnergyDepositCollection>> allSims;
+  event.getManyByType(allSims);
+  std::size_t nDeposits = 0;
+  for (auto const& sims : allSims) {
+    nDeposits += sims->size();
+    for (auto const& hit : *sims) {
+      _hDepositEnergy->Fill(hit.Energy());
+      _hStepLength->Fill(hit.StepLength());
+      if (hit.StepLength() > 0.) _hdEdx->Fill(hit.Energy() / hit.StepLength());
+    }
+  }
+  _hDepositsPerEvent->Fill(nDeposits);
+
+  std::vector<art::Handle<std::vector<simb::MCParticle>>> allParts;
+  event.getManyByType(allParts);
+  std::size_t nParticles = 0;
+  for (auto const& parts : allParts) {
+    nParticles += parts->size();
+    for (auto const& part : *parts) _hSpecies->Fill(speciesBin(part.PdgCode()));
+  }
+  _hParticlesPerEvent->Fill(nParticles);
+
+  std::vector<art::Handle<sim::AuxDetHitCollection>> allAuxHits;
+  event.getManyByType(allAuxHits);
+  std::size_t nAuxHits = 0;
+  for (auto const& hits : allAuxHits) {
+    nAuxHits += hits->size();
+    for (auto const& hit : *hits) _hAuxDetEnergy->Fill(hit.GetEnergyDeposited());
+  }
+  _hAuxDetHitsPerEvent->Fill(nAuxHits);
+} // end analyze
+
+DEFINE_ART_MODULE(larg4::PhysicsSummary)
@@ -0,0 +1,64 @@
+//
+// ScheduleHistograms: histograms of a SharedAnalyzer, filled concurrently by
+// the art schedules.
+//
+// Each histogram is booked once in the TFileService directory, which is what
+// ends up in the output file, and cloned once per schedule. The schedules
+// only fill their own clones, without locking; merge() adds the clones to the
+// booked histograms at the end of the job. TH1::Merge also reconciles the
+// clones of histograms with automatic binning, whose ranges may differ.
+//
+#ifndef LARG4_ANALYSIS_SCHEDULEHISTOGRAMS_H
+#define LARG4_ANALYSIS_SCHEDULEHISTOGRAMS_H
+
+#include "art/Utilities/Globals.h"
+#include "art/Utilities/ScheduleID.h"
+#include "art_root_io/TFileDirectory.h"
+
+#include "TH1.h"
+#include "TList.h"
+
+#include <memory>
+#include <vector>
+
+namespace larg4 {
+
+  class ScheduleHistograms {
+  public:
+    ScheduleHistograms() : clones_(art::Globals::instance()->nschedules()) {}
+
+    /// Book a histogram in dir; returns its index
+    template <typename H, typename... Args>
+    std::size_t make(art::TFileDirectory const& dir, Args... args)
+    {
+      booked_.push_back(dir.make<H>(args...));
+      for (auto& clones : clones_) {
+        std::unique_ptr<TH1> clone{static_cast<TH1*>(booked_.back()->Clone())};
+        clone->SetDirectory(nullptr);
+        clones.push_back(std::move(clone));
+      }
+      return booked_.size() - 1;
+    }
+
+    /// The clone of histogram index of the schedule
+    TH1& operator()(art::ScheduleID sid, std::size_t index) { return *clones_[sid.id()][index]; }
+
+    /// Add the clones of all the schedules to the booked histograms
+    void merge()
+    {
+      for (std::size_t i = 0; i < booked_.size(); ++i) {
+        TList list;
+        for (auto const& clones : clones_) list.Add(clones[i].get());
+        booked_[i]->Merge(&list);
+        for (auto const& clones : clones_) clones[i]->Reset();
+      }
+    }
+
+  private:
+    std::vector<TH1*>                              booked_; // owned by the TFileService
+    std::vector<std::vector<std::unique_ptr<TH1>>> clones_; // [schedule][index]
+  };
+
+} // namespace larg4
+
+#endif // LARG4_ANALYSIS_SCHEDULEHISTOGRAMS_H
@@ -0,0 +1,170 @@
+//
+// compareSummaries: compare the PhysicsSummary histograms of two jobs.
+//
+//   compareSummaries [options] reference.root test.root
+//
+//   -d <directory>        TFileService directory of the histograms
+//                         (default "PhysicsSummary", the module label)
+//   -p <p-value>          minimum Kolmogorov-Smirnov and chi2 p-values
+//                         (default 0.01)
+//   -m <tolerance>        maximum relative difference of the means
+//                         (default 0.02)
+//   -o <tolerance>        maximum difference of the fractions of entries
+//                         in the underflow and overflow bins (default 0.01)
+//   -t <name>:<p>:<m>     p-value and mean tolerance for one histogram,
+//                         may be repeated
+//
+// Every histogram of the reference directory is compared with the one of
+// the same name in the test file; a missing histogram is a failure. The
+// underflow and overflow bins take part in both tests. For histograms with
+// labelled bins (categories, like hSpecies) the mean is meaningless: the
+// largest difference of the fractions of entries in a bin is compared with
+// the mean tolerance instead. The
+// report is written to the standard output and the exit status is 0 when
+// all the histograms agree, 1 otherwise, 2 on usage errors.
+//
+// Root includes.
+#include "TClass.h"
+#include "TDirectory.h"
+#include "TFile.h"
+#include "TH1.h"
+#include "TKey.h"
+
+// STL includes.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+  struct Tolerance_t {
+    double pValue;
+    double mean;
+  };
+
+  int usage(char const* program) {
+    std::cerr << "Usage: " << program << " [-d directory] [-p p-value] [-m mean-tolerance]"
+              << " [-o outside-tolerance] [-t name:p-value:mean-tolerance]... reference.root test.root\n";
+    return 2;
+  }
+
+  // Fraction of the entries in the underflow and overflow bins
+  double outsideFraction(TH1 const& h) {
+    int const nBins = h.GetNbinsX();
+    double const all = h.Integral(0, nBins + 1);
+    return (all > 0.) ? (h.GetBinContent(0) + h.GetBinContent(nBins + 1)) / all : 0.;
+  }
+
+  // Largest difference of the fractions of entries in a bin
+  double binFractionDiff(TH1 const& ref, TH1 const& test) {
+    int const nBins = ref.GetNbinsX();
+    double const refAll = ref.Integral(0, nBins + 1);
+    double const testAll = test.Integral(0, nBins + 1);
+    double diff = 0.;
+    for (int bin = 0; bin <= nBins + 1; ++bin) {
+      double const refFraction = (refAll > 0.) ? ref.GetBinContent(bin) / refAll : 0.;
+      double const testFraction = (testAll > 0.) ? test.GetBinContent(bin) / testAll : 0.;
+      diff = std::max(diff, std::abs(testFraction - refFraction));
+    }
+    return diff;
+  }
+
+  TDirectory* openDirectory(TFile& file, std::string const& dir) {
+    if (file.IsZombie()) return nullptr;
+    return dir.empty() ? &file : file.GetDirectory(dir.c_str());
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  std::string dir = "PhysicsSummary";
+  Tolerance_t defaults{0.01, 0.02};
+  double outsideTolerance = 0.01;
+  std::map<std::string, Tolerance_t> tolerances;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "d:p:m:o:t:")) != -1) {
+    switch (opt) {
+    case 'd': dir = optarg; break;
+    case 'p': defaults.pValue = std::atof(optarg); break;
+    case 'm': defaults.mean = std::atof(optarg); break;
+    case 'o': outsideTolerance = std::atof(optarg); break;
+    case 't': {
+      std::string const spec = optarg;
+      auto const first = spec.find(':');
+      auto const second = spec.find(':', first + 1);
+      if (first == std::string::npos || second == std::string::npos) return usage(argv[0]);
+      tolerances[spec.substr(0, first)] = {std::atof(spec.substr(first + 1, second - first - 1).c_str()),
+                                           std::atof(spec.substr(second + 1).c_str())};
+      break;
+    }
+    default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind != 2) return usage(argv[0]);
+
+  TFile refFile(argv[optind], "READ");
+  TFile testFile(argv[optind + 1], "READ");
+  TDirectory* refDir = openDirectory(refFile, dir);
+  TDirectory* testDir = openDirectory(testFile, dir);
+  if (!refDir || !testDir) {
+    std::cerr << "Cannot read the directory \"" << dir << "\" of " << (refDir ? argv[optind + 1] : argv[optind]) << "\n";
+    return 2;
+  }
+
+  std::cout << "Reference: " << argv[optind] << "\nTest:      " << argv[optind + 1] << "\n\n"
+            << std::left << std::setw(22) << "histogram" << std::right
+            << std::setw(10) << "entries" << std::setw(10) << "entries"
+            << std::setw(12) << "KS p" << std::setw(12) << "chi2 p" << std::setw(12) << "mean diff"
+            << std::setw(12) << "outside" << "  result\n";
+
+  unsigned nFailed = 0, nCompared = 0;
+  TIter next(refDir->GetListOfKeys());
+  while (TKey* key = static_cast<TKey*>(next())) {
+    TClass const* keyClass = TClass::GetClass(key->GetClassName());
+    if (!keyClass || !keyClass->InheritsFrom(TH1::Class())) continue;
+    std::string const name = key->GetName();
+    std::unique_ptr<TH1> ref(static_cast<TH1*>(key->ReadObj()));
+    std::unique_ptr<TH1> test(dynamic_cast<TH1*>(testDir->Get(name.c_str())));
+    ++nCompared;
+    std::cout << std::left << std::setw(22) << name << std::right << std::setw(10) << ref->GetEntries();
+    if (!test) {
+      ++nFailed;
+      std::cout << std::setw(10) << "-" << "  missing in the test file: FAIL\n";
+      continue;
+    }
+    auto const search = tolerances.find(name);
+    Tolerance_t const& tolerance = (search == tolerances.end()) ? defaults : search->second;
+
+    // -- empty on both sides is agreement; the tests are undefined then
+    bool const bothEmpty = ref->GetEntries() == 0 && test->GetEntries() == 0;
+    double const ks = bothEmpty ? 1. : ref->KolmogorovTest(test.get(), "UO");
+    double const chi2 = bothEmpty ? 1. : ref->Chi2Test(test.get(), "UU OF UF");
+    double meanDiff = 0.;
+    if (!bothEmpty && ref->GetXaxis()->GetLabels()) {
+      // -- categories: compare bin by bin
+      meanDiff = binFractionDiff(*ref, *test);
+    } else if (!bothEmpty) {
+      double const scale = std::max(std::abs(ref->GetMean()), ref->GetXaxis()->GetBinWidth(1));
+      meanDiff = std::abs(test->GetMean() - ref->GetMean()) / scale;
+    }
+    double const outsideDiff = std::abs(outsideFraction(*test) - outsideFraction(*ref));
+    bool const pass = ks >= tolerance.pValue && chi2 >= tolerance.pValue && meanDiff <= tolerance.mean
+                      && outsideDiff <= outsideTolerance;
+    if (!pass) ++nFailed;
+    std::cout << std::setw(10) << test->GetEntries()
+              << std::setw(12) << std::setprecision(4) << ks << std::setw(12) << chi2 << std::setw(12) << meanDiff
+              << std::setw(12) << outsideDiff << "  " << (pass ? "pass" : "FAIL") << "\n";
+  }
+
+  std::cout << "\n" << nCompared - nFailed << " of " << nCompared << " histograms agree: "
+            << ((nFailed == 0 && nCompared > 0) ? "PASS" : "FAIL") << "\n";
+  return (nFailed == 0 && nCompared > 0) ? 0 : 1;
+}
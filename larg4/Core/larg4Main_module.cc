@@ -19,13 +19,12 @@
 #include "artg4tk/geantInit/ArtG4DetectorConstruction.hh"
 
 // The actions
-#include "artg4tk/geantInit/ArtG4EventAction.hh"
 #include "artg4tk/geantInit/ArtG4PrimaryGeneratorAction.hh"
-#include "artg4tk/geantInit/ArtG4RunAction.hh"
-#include "artg4tk/geantInit/ArtG4SteppingAction.hh"
-#include "artg4tk/geantInit/ArtG4StackingAction.hh"
-#include "artg4tk/geantInit/ArtG4TrackingAction.hh"
+#include "larg4/Services/larg4UserActions.h"
 #include "larg4/pluginActions/ParticleListAction_service.h" // combined actions.
+#include "larg4/pluginActions/ImportanceBiasingAction_service.h"
+#include "larg4/Services/LArG4Detector_service.h"
+#include "larg4/Services/larg4ActionHolder_service.h"
 
 // Services
 #include "art/Framework/Services/Registry/ServiceHandle.h"
@@ -44,6 +43,11 @@
 
 
 
+#include "Geant4/G4Event.hh"
+#include "Geant4/G4FastSimulationHelper.hh"
+#include "Geant4/G4Navigator.hh"
+#include "Geant4/G4ParticleTable.hh"
+#include "Geant4/G4TransportationManager.hh"
 #include "Geant4/G4UImanager.hh"
 #include "Geant4/G4UIterminal.hh"
 
@@ -138,10 +142,18 @@ larg4::larg4Main::larg4Main(fhicl::ParameterSet const & p)
 {
   produces< std::vector<simb::MCParticle> >();
   produces< art::Assns<simb::MCTruth, simb::MCParticle, sim::GeneratedParticleInfo> >();
+  // Whether the Geant4 event was aborted (e.g. by EarlyAbortAction) and its
+  // products are incomplete
+  produces< bool >("aborted");
+  // Trajectories stripped from the MCParticles and stored compressed
+  if (art::ServiceHandle<ParticleListActionService>()->CompressTrajectories()) {
+    produces< std::vector<larg4::CompressedTrajectory> >();
+  }
 
   // We need all of the services to run @produces@ on the data they will store. We do this
   // by retrieving the holder services.
   art::ServiceHandle<ActionHolderService> actionHolder;
+  art::ServiceHandle<larg4ActionHolderService> larg4ActionHolder;
   art::ServiceHandle<DetectorHolderService> detectorHolder;
 
   detectorHolder->initialize();
@@ -149,6 +161,7 @@ larg4::larg4Main::larg4Main(fhicl::ParameterSet const & p)
   detectorHolder -> constructAllLVs();
   // And running @callArtProduces@ on each
   actionHolder -> callArtProduces(producesCollector());
+  larg4ActionHolder -> callArtProduces(producesCollector());
   detectorHolder -> callArtProduces(producesCollector());
 
   // ((artg4tk::SteppingActionBase*)&*pla)-> callArtProduces(this);
@@ -198,6 +211,9 @@ void larg4::larg4Main::beginRun(art::Run & r)
   // Get all of the actions and initialize them
   art::ServiceHandle<ActionHolderService> actionHolder;
   actionHolder->initialize();
+  art::ServiceHandle<larg4ActionHolderService> larg4ActionHolder;
+  larg4ActionHolder->initialize();
+  larg4ActionHolder->setCurrArtRun(r);
 
   // Store the run in the action holder
   actionHolder->setCurrArtRun(r);
@@ -208,17 +224,42 @@ void larg4::larg4Main::beginRun(art::Run & r)
   // Note that these actions (and ArtG4PrimaryGeneratorAction above) are all
   // generic actions that really don't do much on their own. Rather, to
   // use the power of actions, one must create action objects (derived from
-  // @ActionBase@) and register them with the Art @ActionHolder@ service.
-  // See @ActionBase@ and/or @ActionHolderService@ for more information.
-  runManager_ -> SetUserAction(new artg4tk::ArtG4SteppingAction);
-  runManager_ -> SetUserAction(new artg4tk::ArtG4StackingAction);
-  runManager_ -> SetUserAction(new artg4tk::ArtG4EventAction);
-  runManager_ -> SetUserAction(new artg4tk::ArtG4TrackingAction);
-  runManager_ -> SetUserAction(new artg4tk::ArtG4RunAction);
+  // @ActionBase@) and register them with the Art @ActionHolder@ service,
+  // or with @larg4ActionHolder@ for the larg4 tracking, stepping and stacking
+  // action bases. See @ActionBase@, @ActionHolderService@ and/or
+  // @larg4ActionHolderService@ for more information.
+  runManager_ -> SetUserAction(new larg4::LArG4SteppingAction);
+  runManager_ -> SetUserAction(new larg4::LArG4StackingAction);
+  runManager_ -> SetUserAction(new larg4::LArG4EventAction);
+  runManager_ -> SetUserAction(new larg4::LArG4TrackingAction);
+  runManager_ -> SetUserAction(new larg4::LArG4RunAction);
 
   runManager_->Initialize();
   physicsListHolder->initializePhysicsList();
 
+  // Fast simulation models defined by the detector (e.g. Woodcock tracking)
+  // need the fast simulation process attached to the particles they handle
+  if (art::ServiceRegistry::isAvailable<LArG4DetectorService>()) {
+    art::ServiceHandle<LArG4DetectorService const> detector;
+    for (auto const& name : detector->GetFastSimulationParticles()) {
+      G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(name);
+      if (!particle) {
+        throw cet::exception("larg4Main") << "Unknown particle " << name
+                                          << " requested for fast simulation.\n";
+      }
+      G4FastSimulationHelper::ActivateFastSimulation(particle->GetProcessManager());
+      logInfo_ << "Fast simulation activated for " << name << "\n";
+    }
+  }
+
+  // Importance biasing needs the full geometry tree and the process managers
+  // of the biased particles, so it is configured after the initialization
+  if (art::ServiceRegistry::isAvailable<ImportanceBiasingActionService>()) {
+    art::ServiceHandle<ImportanceBiasingActionService> biasing;
+    biasing->configure(G4TransportationManager::GetTransportationManager()
+                       ->GetNavigatorForTracking()->GetWorldVolume());
+  }
+
   //get the pointer to the User Interface manager
   UI_ = G4UImanager::GetUIpointer();
 
@@ -260,9 +301,11 @@ void larg4::larg4Main::produce(art::Event & e)
 {
   // The holder services need the event
   art::ServiceHandle<ActionHolderService> actionHolder;
+  art::ServiceHandle<larg4ActionHolderService> larg4ActionHolder;
   art::ServiceHandle<DetectorHolderService> detectorHolder;
   art::ServiceHandle<ParticleListActionService> pla;
   actionHolder -> setCurrArtEvent(e);
+  larg4ActionHolder -> setCurrArtEvent(e);
   detectorHolder -> setCurrArtEvent(e);
   pla -> setCurrArtEvent(e);
   pla -> setProductID( e.getProductID<std::vector<simb::MCParticle>>());
@@ -272,6 +315,10 @@ void larg4::larg4Main::produce(art::Event & e)
 
   //  logInfo_ << "Producing event " << e.id().event() << "\n" << endl;
 
+  // The current event is only available until the end of the event
+  G4Event const* g4event = runManager_ -> GetCurrentEvent();
+  bool const aborted = g4event && g4event->IsAborted();
+
   // Done with the event
   runManager_ -> BeamOnEndEvent();
 
@@ -279,6 +326,8 @@ void larg4::larg4Main::produce(art::Event & e)
   auto &tpassn = pla->GetAssnsMCTruthToMCParticle();
   e.put(std::move(partCol));
   e.put(std::move(tpassn));
+  e.put(std::make_unique<bool>(aborted), "aborted");
+  if (pla->CompressTrajectories()) e.put(std::move(pla->GetCompressedTrajectories()));
 }
 
 // At end run
@@ -286,6 +335,7 @@ void larg4::larg4Main::endRun(art::Run & r)
 {
   art::ServiceHandle<ActionHolderService> actionHolder;
   actionHolder->setCurrArtRun(r);
+  art::ServiceHandle<larg4ActionHolderService>()->setCurrArtRun(r);
   runManager_ -> BeamOnEndRun();
 }
 
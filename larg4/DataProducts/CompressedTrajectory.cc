@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  CompressedTrajectory.cc
+/// \brief Compact encoding of the trajectory of a simb::MCParticle.
+////////////////////////////////////////////////////////////////////////
+#include "larg4/DataProducts/CompressedTrajectory.h"
+
+#include "TLorentzVector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+  void putVarint(std::vector<unsigned char>& data, std::uint64_t value) {
+    while (value >= 0x80) {
+      data.push_back(static_cast<unsigned char>(value | 0x80));
+      value >>= 7;
+    }
+    data.push_back(static_cast<unsigned char>(value));
+  }
+
+  std::uint64_t getVarint(std::vector<unsigned char> const& data, size_t& pos) {
+    std::uint64_t value = 0;
+    for (int shift = 0; pos < data.size(); shift += 7) {
+      unsigned char const byte = data[pos++];
+      value |= std::uint64_t(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) break;
+    }
+    return value;
+  }
+
+  // Signed values interleaved with the positive ones: 0, -1, 1, -2, ...
+  void putSigned(std::vector<unsigned char>& data, std::int64_t value) {
+    putVarint(data, (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63));
+  }
+
+  std::int64_t getSigned(std::vector<unsigned char> const& data, size_t& pos) {
+    std::uint64_t const value = getVarint(data, pos);
+    return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+  }
+
+} // namespace
+
+larg4::CompressedTrajectory::CompressedTrajectory(int trackId,
+                                                  simb::MCTrajectory const& trajectory,
+                                                  simb::MCTrajectory::ProcessMap const& processes,
+                                                  double positionResolution,
+                                                  double timeResolution,
+                                                  double momentumResolution)
+  : fTrackId(trackId)
+  , fNPoints(trajectory.size())
+  , fPositionResolution(positionResolution)
+  , fTimeResolution(timeResolution)
+{
+  if (fNPoints == 0) return;
+
+  TLorentzVector const& x0 = trajectory.Position(0);
+  TLorentzVector const& p0 = trajectory.Momentum(0);
+  for (int i = 0; i < 4; ++i) {
+    fFirst[i] = x0[i];
+    fFirst[4 + i] = p0[i];
+  }
+  // -- particles starting at rest use the resolution as an absolute value in GeV
+  fMomentumResolution = momentumResolution * (p0.P() > 0. ? p0.P() : 1.);
+
+  double const resolution[7] = {fPositionResolution, fPositionResolution, fPositionResolution,
+                                fTimeResolution,
+                                fMomentumResolution, fMomentumResolution, fMomentumResolution};
+  std::int64_t previous[7] = {};
+  fPoints.reserve(10 * (fNPoints - 1));
+  for (unsigned i = 1; i < fNPoints; ++i) {
+    TLorentzVector const& x = trajectory.Position(i);
+    TLorentzVector const& p = trajectory.Momentum(i);
+    double const values[7] = {x.X() - fFirst[0], x.Y() - fFirst[1], x.Z() - fFirst[2], x.T() - fFirst[3],
+                              p.Px() - fFirst[4], p.Py() - fFirst[5], p.Pz() - fFirst[6]};
+    for (int k = 0; k < 7; ++k) {
+      std::int64_t const quantized = std::llround(values[k] / resolution[k]);
+      putSigned(fPoints, quantized - previous[k]);
+      previous[k] = quantized;
+    }
+  }
+
+  size_t previousIndex = 0;
+  for (auto const& [index, code] : processes) {
+    putVarint(fProcesses, index - previousIndex);
+    fProcesses.push_back(code);
+    previousIndex = index;
+  }
+}
+
+simb::MCTrajectory larg4::CompressedTrajectory::Trajectory() const {
+  simb::MCTrajectory trajectory;
+  if (fNPoints == 0) return trajectory;
+
+  TLorentzVector const x0(fFirst[0], fFirst[1], fFirst[2], fFirst[3]);
+  TLorentzVector const p0(fFirst[4], fFirst[5], fFirst[6], fFirst[7]);
+  trajectory.push_back(x0, p0);
+  double const mass2 = std::max(p0.E() * p0.E() - p0.Vect().Mag2(), 0.);
+
+  double const resolution[7] = {fPositionResolution, fPositionResolution, fPositionResolution,
+                                fTimeResolution,
+                                fMomentumResolution, fMomentumResolution, fMomentumResolution};
+  std::int64_t quantized[7] = {};
+  size_t pos = 0;
+  for (unsigned i = 1; i < fNPoints; ++i) {
+    double values[7];
+    for (int k = 0; k < 7; ++k) {
+      quantized[k] += getSigned(fPoints, pos);
+      values[k] = quantized[k] * resolution[k] + fFirst[k];
+    }
+    double const p2 = values[4] * values[4] + values[5] * values[5] + values[6] * values[6];
+    trajectory.push_back(TLorentzVector(values[0], values[1], values[2], values[3]),
+                         TLorentzVector(values[4], values[5], values[6], std::sqrt(p2 + mass2)));
+  }
+  return trajectory;
+}
+
+simb::MCTrajectory::ProcessMap larg4::CompressedTrajectory::Processes() const {
+  simb::MCTrajectory::ProcessMap processes;
+  size_t index = 0;
+  size_t pos = 0;
+  while (pos < fProcesses.size()) {
+    index += getVarint(fProcesses, pos);
+    processes.emplace_back(index, fProcesses[pos++]);
+  }
+  return processes;
+}
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////
+/// \file  CompressedTrajectory.h
+/// \brief Compact encoding of the trajectory of a simb::MCParticle.
+///
+/// The first point is kept at full precision. The following points are
+/// quantized with respect to it: positions and times at a fixed resolution
+/// (e.g. 10 um and 0.01 ns), momenta at a resolution relative to the starting
+/// momentum. Each point is stored as the differences of its quantized values
+/// from those of the previous point, as zigzag variable length integers,
+/// which take one or two bytes for the short steps of a typical trajectory.
+/// The energy is recomputed from the momentum and the mass of the first
+/// point. The process map (trajectory point index and process code) is kept
+/// as is, also delta-encoded.
+///
+/// The quantization errors do not accumulate along the trajectory: every
+/// point is within half a resolution step of its original value.
+////////////////////////////////////////////////////////////////////////
+#ifndef LARG4_DATAPRODUCTS_COMPRESSEDTRAJECTORY_H
+#define LARG4_DATAPRODUCTS_COMPRESSEDTRAJECTORY_H
+
+#include "nusimdata/SimulationBase/MCTrajectory.h"
+
+#include <vector>
+
+namespace larg4 {
+
+  class CompressedTrajectory {
+  public:
+    /// Default constructor, for ROOT I/O
+    CompressedTrajectory() = default;
+
+    /// Encode a trajectory; resolutions in cm, ns and relative to the
+    /// magnitude of the first momentum
+    CompressedTrajectory(int trackId,
+                         simb::MCTrajectory const& trajectory,
+                         simb::MCTrajectory::ProcessMap const& processes,
+                         double positionResolution,
+                         double timeResolution,
+                         double momentumResolution);
+
+    int      TrackId() const { return fTrackId; }
+    unsigned size() const { return fNPoints; }
+    bool     empty() const { return fNPoints == 0; }
+
+    /// Bytes used by the encoded points and processes
+    size_t   EncodedSize() const { return fPoints.size() + fProcesses.size(); }
+
+    /// Decode the trajectory points
+    simb::MCTrajectory Trajectory() const;
+
+    /// Decode the process map
+    simb::MCTrajectory::ProcessMap Processes() const;
+
+  private:
+    int                        fTrackId = 0;
+    unsigned                   fNPoints = 0;
+    double                     fPositionResolution = 0.; ///< [cm]
+    double                     fTimeResolution = 0.;     ///< [ns]
+    double                     fMomentumResolution = 0.; ///< [GeV], absolute
+    double                     fFirst[8] = {};           ///< x, y, z, t, px, py, pz, E of the first point
+    std::vector<unsigned char> fPoints;                  ///< encoded points after the first one
+    std::vector<unsigned char> fProcesses;               ///< encoded process map
+  };
+
+} // namespace larg4
+
+#endif // LARG4_DATAPRODUCTS_COMPRESSEDTRAJECTORY_H
@@ -0,0 +1,4 @@
+#include "canvas/Persistency/Common/Wrapper.h"
+#include "larg4/DataProducts/CompressedTrajectory.h"
+
+#include <vector>
@@ -51,6 +51,8 @@ void  AuxDetSD::Initialize(G4HCofThisEvent* ) {
   G4double edep = step->GetTotalEnergyDeposit() / CLHEP::MeV;
   if (edep == 0.) return false;
   G4Track * track = step->GetTrack();
+  // -- tracks carry a weight different from 1 only when biasing is used
+  edep *= track->GetWeight();
   const unsigned int trackID = track->GetTrackID();
   unsigned int ID = step->GetPreStepPoint()->GetPhysicalVolume()->GetCopyNo();
   TempHit tmpHit = TempHit(
@@ -0,0 +1,126 @@
+//=============================================================================
+// BuiltinSensitiveDetectors.cc: registration of the sensitive detector types
+// available to LArG4DetectorService without any plugin library
+//=============================================================================
+// framework includes:
+#include "art/Framework/Core/ProducesCollector.h"
+#include "art/Framework/Principal/Event.h"
+// larg4 includes:
+#include "larg4/Services/SensitiveDetectorRegistry.h"
+#include "larg4/Services/SimEnergyDepositSD.h"
+#include "larg4/Services/AuxDetSD.h"
+#include "lardataobj/Simulation/SimEnergyDeposit.h"
+#include "lardataobj/Simulation/AuxDetHit.h"
+// artg4tk includes:
+#include "artg4tk/pluginDetectors/gdml/CalorimeterSD.hh"
+#include "artg4tk/pluginDetectors/gdml/CalorimeterHit.hh"
+#include "artg4tk/pluginDetectors/gdml/DRCalorimeterSD.hh"
+#include "artg4tk/pluginDetectors/gdml/DRCalorimeterHit.hh"
+#include "artg4tk/pluginDetectors/gdml/ByParticle.hh"
+#include "artg4tk/pluginDetectors/gdml/PhotonSD.hh"
+#include "artg4tk/pluginDetectors/gdml/PhotonHit.hh"
+#include "artg4tk/pluginDetectors/gdml/TrackerSD.hh"
+#include "artg4tk/pluginDetectors/gdml/TrackerHit.hh"
+#include "artg4tk/pluginDetectors/gdml/HadInteractionSD.hh"
+#include "artg4tk/pluginDetectors/gdml/HadIntAndEdepTrkSD.hh"
+// Geant 4 includes:
+#include "Geant4/G4SDManager.hh"
+
+#include <memory>
+
+namespace {
+
+  // Sensitive detectors with a single hit collection, put with the instance name
+  template <typename SD, typename Hits>
+  larg4::SensitiveDetectorRegistry::Factory_t simpleFactory() {
+    return {
+      [](std::string const& name) -> G4VSensitiveDetector* {
+        SD* sd = new SD(name);
+        G4SDManager::GetSDMpointer()->AddNewDetector(sd);
+        return sd;
+      },
+      [](art::ProducesCollector& collector, std::string const& instance) {
+        collector.produces<Hits>(instance);
+      },
+      [](G4VSensitiveDetector* sd, art::Event& e, std::string const& instance) {
+        e.put(std::make_unique<Hits>(static_cast<SD*>(sd)->GetHits()), instance);
+      }
+    };
+  }
+
+}
+
+void larg4::registerBuiltinSensitiveDetectors(SensitiveDetectorRegistry& registry) {
+
+  registry.add("Calorimeter", simpleFactory<artg4tk::CalorimeterSD, artg4tk::CalorimeterHitCollection>());
+  registry.add("PhotonDetector", simpleFactory<artg4tk::PhotonSD, artg4tk::PhotonHitCollection>());
+  registry.add("Tracker", simpleFactory<artg4tk::TrackerSD, artg4tk::TrackerHitCollection>());
+  registry.add("SimEnergyDeposit", simpleFactory<SimEnergyDepositSD, sim::SimEnergyDepositCollection>());
+  registry.add("AuxDet", simpleFactory<AuxDetSD, sim::AuxDetHitCollection>());
+
+  registry.add("DRCalorimeter", {
+    [](std::string const& name) -> G4VSensitiveDetector* {
+      auto* sd = new artg4tk::DRCalorimeterSD(name);
+      G4SDManager::GetSDMpointer()->AddNewDetector(sd);
+      return sd;
+    },
+    [](art::ProducesCollector& collector, std::string const& instance) {
+      collector.produces<artg4tk::DRCalorimeterHitCollection>(instance);
+      collector.produces<artg4tk::ByParticle>(instance + "Edep");
+      collector.produces<artg4tk::ByParticle>(instance + "NCeren");
+    },
+    [](G4VSensitiveDetector* sd, art::Event& e, std::string const& instance) {
+      auto* drcalsd = static_cast<artg4tk::DRCalorimeterSD*>(sd);
+      e.put(std::make_unique<artg4tk::DRCalorimeterHitCollection>(drcalsd->GetHits()), instance);
+      e.put(std::make_unique<artg4tk::ByParticle>(drcalsd->GetEbyParticle()), instance + "Edep");
+      e.put(std::make_unique<artg4tk::ByParticle>(drcalsd->GetNCerenbyParticle()), instance + "NCeren");
+    }
+  });
+
+  //
+  // NOTE(JVY): 1st hadronic interaction will be fetched as-is from HadInteractionSD
+  //            a copy (via copy ctor) will be placed directly into art::Event
+  //
+  registry.add("HadInteraction", {
+    [](std::string const& name) -> G4VSensitiveDetector* {
+      // NOTE: The SD is added to the G4SDManager in the HadInteractionSD ctor
+      return new artg4tk::HadInteractionSD(name);
+    },
+    [](art::ProducesCollector& collector, std::string const& instance) {
+      collector.produces<artg4tk::ArtG4tkVtx>(instance); // NO volume in the product instance name (for now)
+    },
+    [](G4VSensitiveDetector* sd, art::Event& e, std::string const& instance) {
+      auto* hisd = static_cast<artg4tk::HadInteractionSD*>(sd);
+      const artg4tk::ArtG4tkVtx& inter = hisd->Get1stInteraction();
+      if (inter.GetNumOutcoming() > 0) {
+        e.put(std::make_unique<artg4tk::ArtG4tkVtx>(inter), instance); // only the prefix as instance name
+      }
+      hisd->clear(); // clear out after moving info to EDM; no need to clean out in the producer !
+    },
+    false
+  });
+
+  registry.add("HadIntAndEdepTrk", {
+    [](std::string const& name) -> G4VSensitiveDetector* {
+      // NOTE: The SD is added to the G4SDManager in the HadIntAndEdepTrkSD ctor
+      return new artg4tk::HadIntAndEdepTrkSD(name);
+    },
+    [](art::ProducesCollector& collector, std::string const& instance) {
+      collector.produces<artg4tk::ArtG4tkVtx>(instance);
+      collector.produces<artg4tk::TrackerHitCollection>(instance);
+    },
+    [](G4VSensitiveDetector* sd, art::Event& e, std::string const& instance) {
+      auto* hisd = static_cast<artg4tk::HadIntAndEdepTrkSD*>(sd);
+      const artg4tk::ArtG4tkVtx& inter = hisd->Get1stInteraction();
+      if (inter.GetNumOutcoming() > 0) {
+        e.put(std::make_unique<artg4tk::ArtG4tkVtx>(inter), instance); // only the prefix as instance name
+      }
+      const artg4tk::TrackerHitCollection& trkhits = hisd->GetEdepTrkHits();
+      if (!trkhits.empty()) {
+        e.put(std::make_unique<artg4tk::TrackerHitCollection>(trkhits), instance);
+      }
+      hisd->clear(); // clear out after moving info to EDM; no need to clean out in the producer !
+    },
+    false
+  });
+}
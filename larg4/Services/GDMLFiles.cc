@@ -0,0 +1,157 @@
+//=============================================================================
+// GDMLFiles.cc: list and hash the files of a GDML geometry, see GDMLFiles.h
+//=============================================================================
+#include "larg4/Services/GDMLFiles.h"
+#include "cetlib_except/exception.h"
+// Xerces includes:
+#include <xercesc/parsers/XercesDOMParser.hpp>
+#include <xercesc/sax/ErrorHandler.hpp>
+#include <xercesc/sax/SAXParseException.hpp>
+#include <xercesc/util/PlatformUtils.hpp>
+#include <xercesc/util/XMLString.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <regex>
+#include <thread>
+
+namespace {
+
+  std::string readFile(std::string const& fileName) {
+    std::ifstream in(fileName, std::ios::binary);
+    if (!in) {
+      throw cet::exception("GDMLFiles") << "Cannot open file: " << fileName << "\n";
+    }
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+
+  std::string directoryOf(std::string const& fileName) {
+    auto const slash = fileName.rfind('/');
+    return (slash == std::string::npos) ? std::string() : fileName.substr(0, slash + 1);
+  }
+
+  // Collects the validation messages of one file
+  class ValidationHandler : public xercesc::ErrorHandler {
+  public:
+    explicit ValidationHandler(std::string const& fileName) : fFileName(fileName) {}
+
+    void warning(xercesc::SAXParseException const& e) override { add("warning", e); }
+    void error(xercesc::SAXParseException const& e) override { add("error", e); }
+    void fatalError(xercesc::SAXParseException const& e) override { add("fatal error", e); }
+    void resetErrors() override {}
+
+    std::vector<std::string> const& messages() const { return fMessages; }
+
+  private:
+    void add(char const* level, xercesc::SAXParseException const& e) {
+      char* message = xercesc::XMLString::transcode(e.getMessage());
+      fMessages.push_back(fFileName + ":" + std::to_string(e.getLineNumber()) + ": " + level + ": " + message);
+      xercesc::XMLString::release(&message);
+    }
+
+    std::string              fFileName;
+    std::vector<std::string> fMessages;
+  };
+
+  // The text without its XML comments, whose references are not read by the parser
+  std::string stripComments(std::string const& content) {
+    std::string result;
+    result.reserve(content.size());
+    size_t pos = 0;
+    while (pos < content.size()) {
+      size_t const begin = content.find("<!--", pos);
+      if (begin == std::string::npos) {
+        result.append(content, pos, std::string::npos);
+        break;
+      }
+      result.append(content, pos, begin - pos);
+      size_t const end = content.find("-->", begin + 4);
+      if (end == std::string::npos) break;
+      pos = end + 3;
+    }
+    return result;
+  }
+
+  void addGDMLFiles(std::string const& fileName, std::vector<std::string>& files) {
+    if (std::find(files.begin(), files.end(), fileName) != files.end()) return;
+    files.push_back(fileName);
+
+    static std::regex const reference{R"((?:SYSTEM\s+"([^"]+)")|(?:<file\s+name\s*=\s*"([^"]+)"))"};
+    std::string const content = stripComments(readFile(fileName));
+    std::string const directory = directoryOf(fileName);
+    for (std::sregex_iterator it(content.begin(), content.end(), reference), end; it != end; ++it) {
+      std::string referenced = (*it)[1].matched ? (*it)[1].str() : (*it)[2].str();
+      if (referenced.front() != '/') referenced = directory + referenced;
+      addGDMLFiles(referenced, files);
+    }
+  }
+
+}
+
+std::vector<std::string> larg4::listGDMLFiles(std::string const& gdmlFile) {
+  std::vector<std::string> files;
+  addGDMLFiles(gdmlFile, files);
+  return files;
+}
+
+std::uint64_t larg4::hashFiles(std::vector<std::string> const& files) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (auto const& fileName : files) {
+    hash = hashString(readFile(fileName), hash);
+  }
+  return hash;
+}
+
+std::uint64_t larg4::hashString(std::string const& text, std::uint64_t hash) {
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::vector<std::string> larg4::validateGDMLFiles(std::vector<std::string> const& files, unsigned nThreads) {
+  // -- the external entities (e.g. materials.xml) are validated within their document
+  std::vector<std::string> documents;
+  for (auto const& fileName : files) {
+    if (readFile(fileName).find("<gdml") != std::string::npos) documents.push_back(fileName);
+  }
+
+  // -- same parser settings as G4GDMLRead::Read with validation
+  xercesc::XMLPlatformUtils::Initialize();
+  std::vector<std::string> messages;
+  std::mutex messagesMutex;
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+    for (size_t i = next++; i < documents.size(); i = next++) {
+      ValidationHandler handler(documents[i]);
+      xercesc::XercesDOMParser parser;
+      parser.setValidationScheme(xercesc::XercesDOMParser::Val_Always);
+      parser.setValidationSchemaFullChecking(true);
+      parser.setCreateEntityReferenceNodes(false);
+      parser.setDoNamespaces(true);
+      parser.setDoSchema(true);
+      parser.setErrorHandler(&handler);
+      try {
+        parser.parse(documents[i].c_str());
+      }
+      catch (xercesc::XMLException const& e) {
+        char* message = xercesc::XMLString::transcode(e.getMessage());
+        std::lock_guard<std::mutex> lock(messagesMutex);
+        messages.push_back(documents[i] + ": " + message);
+        xercesc::XMLString::release(&message);
+      }
+      std::lock_guard<std::mutex> lock(messagesMutex);
+      messages.insert(messages.end(), handler.messages().begin(), handler.messages().end());
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned t = 1; t < std::min<size_t>(nThreads, documents.size()); ++t) threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+  xercesc::XMLPlatformUtils::Terminate();
+  return messages;
+}
@@ -0,0 +1,34 @@
+//=============================================================================
+// GDMLFiles.h: helpers to find all the files a GDML geometry is made of (the
+// main file, the external entities it declares with SYSTEM "..." and the
+// modules it includes with <physvol><file name="..."/>), to hash them and to
+// validate them against the GDML schema.
+//=============================================================================
+#ifndef GDMLFiles_h
+#define GDMLFiles_h 1
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace larg4 {
+
+  // The main GDML file followed by all the files it references, recursively;
+  // relative names are resolved with respect to the referencing file, and
+  // the references inside XML comments are ignored, as by the parser
+  std::vector<std::string> listGDMLFiles(std::string const& gdmlFile);
+
+  // 64-bit FNV-1a hash of the contents of the files, in the given order
+  std::uint64_t hashFiles(std::vector<std::string> const& files);
+
+  // Continue a 64-bit FNV-1a hash (e.g. from hashFiles) with the given text
+  std::uint64_t hashString(std::string const& text, std::uint64_t hash);
+
+  // Validate the files that are complete GDML documents (the main file and
+  // the modules) against the schema, on up to nThreads threads; returns the
+  // validation messages, which G4GDMLParser reports as warnings too
+  std::vector<std::string> validateGDMLFiles(std::vector<std::string> const& files, unsigned nThreads);
+
+}   // namespace larg4
+
+#endif
@@ -0,0 +1,217 @@
+//=============================================================================
+// GeometryReport.cc: memory footprint and complexity of the geometry, see
+// GeometryReport.h
+//=============================================================================
+#include "larg4/Services/GeometryReport.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+// Geant 4 includes:
+#include "Geant4/G4Box.hh"
+#include "Geant4/G4Cons.hh"
+#include "Geant4/G4DisplacedSolid.hh"
+#include "Geant4/G4ExtrudedSolid.hh"
+#include "Geant4/G4GeometryManager.hh"
+#include "Geant4/G4IntersectionSolid.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4PhysicalVolumeStore.hh"
+#include "Geant4/G4Polycone.hh"
+#include "Geant4/G4Polyhedra.hh"
+#include "Geant4/G4PVParameterised.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4PVReplica.hh"
+#include "Geant4/G4SmartVoxelHeader.hh"
+#include "Geant4/G4SmartVoxelStat.hh"
+#include "Geant4/G4SolidStore.hh"
+#include "Geant4/G4Sphere.hh"
+#include "Geant4/G4SubtractionSolid.hh"
+#include "Geant4/G4TessellatedSolid.hh"
+#include "Geant4/G4Torus.hh"
+#include "Geant4/G4Trap.hh"
+#include "Geant4/G4Trd.hh"
+#include "Geant4/G4TriangularFacet.hh"
+#include "Geant4/G4Tubs.hh"
+#include "Geant4/G4UnionSolid.hh"
+
+// C++ includes
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+
+  std::size_t solidBytes(G4VSolid const* solid) {
+    static std::map<G4String, std::size_t> const sizes{
+      {"G4Box", sizeof(G4Box)},               {"G4Tubs", sizeof(G4Tubs)},
+      {"G4Cons", sizeof(G4Cons)},             {"G4Trd", sizeof(G4Trd)},
+      {"G4Trap", sizeof(G4Trap)},             {"G4Sphere", sizeof(G4Sphere)},
+      {"G4Torus", sizeof(G4Torus)},           {"G4Polycone", sizeof(G4Polycone)},
+      {"G4Polyhedra", sizeof(G4Polyhedra)},   {"G4ExtrudedSolid", sizeof(G4ExtrudedSolid)},
+      {"G4UnionSolid", sizeof(G4UnionSolid)}, {"G4SubtractionSolid", sizeof(G4SubtractionSolid)},
+      {"G4IntersectionSolid", sizeof(G4IntersectionSolid)},
+      {"G4DisplacedSolid", sizeof(G4DisplacedSolid)}};
+    if (auto const* tessellated = dynamic_cast<G4TessellatedSolid const*>(solid)) {
+      return sizeof(G4TessellatedSolid) + tessellated->GetNumberOfFacets() * sizeof(G4TriangularFacet);
+    }
+    auto search = sizes.find(solid->GetEntityType());
+    return (search == sizes.end()) ? sizeof(G4Box) : search->second;
+  }
+
+  std::size_t logicalBytes(G4LogicalVolume const* lv) {
+    return sizeof(G4LogicalVolume) + lv->GetNoDaughters() * sizeof(G4VPhysicalVolume*);
+  }
+
+  std::size_t physicalBytes(G4VPhysicalVolume const* pv) {
+    if (pv->IsParameterised()) return sizeof(G4PVParameterised);
+    if (pv->IsReplicated()) return sizeof(G4PVReplica);
+    return sizeof(G4PVPlacement) + (pv->GetRotation() ? sizeof(G4RotationMatrix) : 0);
+  }
+
+  struct Subtree_t {
+    std::size_t bytes;
+    double      touchables;
+  };
+
+  Subtree_t const& subtree(G4LogicalVolume const* lv,
+                           std::unordered_map<G4LogicalVolume const*, Subtree_t>& cache) {
+    if (auto search = cache.find(lv); search != cache.end()) return search->second;
+    Subtree_t result{logicalBytes(lv) + solidBytes(lv->GetSolid()), 1.};
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+      G4VPhysicalVolume const* daughter = lv->GetDaughter(i);
+      Subtree_t const& below = subtree(daughter->GetLogicalVolume(), cache);
+      result.bytes += physicalBytes(daughter) + below.bytes;
+      result.touchables += daughter->GetMultiplicity() * below.touchables;
+    }
+    return cache[lv] = result;
+  }
+
+  std::string jsonString(std::string const& s) {
+    std::string result = "\"";
+    for (char c : s) {
+      if (c == '"' || c == '\\') result += '\\';
+      result += c;
+    }
+    return result + "\"";
+  }
+
+  std::string kB(std::size_t bytes) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) << bytes / 1024. << " kB";
+    return ss.str();
+  }
+
+}
+
+larg4::GeometryReport::GeometryReport(fhicl::ParameterSet const& p)
+  : fNTop(p.get<unsigned>("nTop", 10)),
+    fJsonFile(p.get<std::string>("jsonFile", ""))
+{}
+
+void larg4::GeometryReport::write(G4VPhysicalVolume* world) const {
+  G4SolidStore const* solids = G4SolidStore::GetInstance();
+  G4LogicalVolumeStore const* lvs = G4LogicalVolumeStore::GetInstance();
+  G4PhysicalVolumeStore const* pvs = G4PhysicalVolumeStore::GetInstance();
+
+  std::size_t solidTotal = 0, facets = 0;
+  for (auto const* solid : *solids) {
+    solidTotal += solidBytes(solid);
+    if (auto const* tessellated = dynamic_cast<G4TessellatedSolid const*>(solid)) {
+      facets += tessellated->GetNumberOfFacets();
+    }
+  }
+  std::size_t lvTotal = 0;
+  for (auto const* lv : *lvs) lvTotal += logicalBytes(lv);
+  std::size_t pvTotal = 0, rotations = 0;
+  for (auto const* pv : *pvs) {
+    pvTotal += physicalBytes(pv);
+    if (pv->GetRotation() && !pv->IsReplicated()) ++rotations;
+  }
+
+  // -- the voxel headers only exist once the geometry is closed
+  G4GeometryManager* geometryManager = G4GeometryManager::GetInstance();
+  bool const wasClosed = geometryManager->IsGeometryClosed();
+  if (!wasClosed) geometryManager->CloseGeometry(true);
+  std::size_t voxelTotal = 0, nVoxelHeaders = 0;
+  std::vector<std::pair<G4LogicalVolume const*, std::size_t>> voxels;
+  for (auto const* lv : *lvs) {
+    if (G4SmartVoxelHeader const* header = lv->GetVoxelHeader()) {
+      std::size_t const bytes = G4SmartVoxelStat(lv, header, 0., 0.).GetMemoryUse();
+      voxelTotal += bytes;
+      ++nVoxelHeaders;
+      voxels.emplace_back(lv, bytes);
+    }
+  }
+  if (!wasClosed) geometryManager->OpenGeometry();
+
+  // -- top lists
+  auto bySecond = [](auto const& a, auto const& b) { return a.second > b.second; };
+  std::sort(voxels.begin(), voxels.end(), bySecond);
+  if (voxels.size() > fNTop) voxels.resize(fNTop);
+
+  std::vector<std::pair<G4LogicalVolume const*, G4int>> mothers;
+  for (auto const* lv : *lvs) {
+    if (lv->GetNoDaughters() > 0) mothers.emplace_back(lv, lv->GetNoDaughters());
+  }
+  std::sort(mothers.begin(), mothers.end(), bySecond);
+  if (mothers.size() > fNTop) mothers.resize(fNTop);
+
+  std::unordered_map<G4LogicalVolume const*, Subtree_t> cache;
+  double const touchables = subtree(world->GetLogicalVolume(), cache).touchables;
+  std::vector<std::pair<G4LogicalVolume const*, Subtree_t>> heaviest(cache.begin(), cache.end());
+  std::sort(heaviest.begin(), heaviest.end(), [](auto const& a, auto const& b) { return a.second.bytes > b.second.bytes; });
+  if (heaviest.size() > fNTop) heaviest.resize(fNTop);
+
+  // -- log
+  std::ostringstream ss;
+  ss << "Geometry report (estimated memory):\n"
+     << "  solids:            " << std::setw(8) << solids->size() << "  " << kB(solidTotal)
+     << " (" << facets << " tessellated facets)\n"
+     << "  logical volumes:   " << std::setw(8) << lvs->size() << "  " << kB(lvTotal) << "\n"
+     << "  physical volumes:  " << std::setw(8) << pvs->size() << "  " << kB(pvTotal)
+     << " (" << rotations << " rotated)\n"
+     << "  voxel headers:     " << std::setw(8) << nVoxelHeaders << "  " << kB(voxelTotal) << "\n"
+     << "  total:                       " << kB(solidTotal + lvTotal + pvTotal + voxelTotal) << "\n"
+     << "  touchables:        " << std::setw(8) << touchables << "\n"
+     << "Mothers with most daughters:\n";
+  for (auto const& [lv, n] : mothers) ss << "  " << std::left << std::setw(32) << lv->GetName() << std::right << std::setw(8) << n << "\n";
+  ss << "Largest voxel headers:\n";
+  for (auto const& [lv, bytes] : voxels) ss << "  " << std::left << std::setw(32) << lv->GetName() << std::right << std::setw(12) << kB(bytes) << "\n";
+  ss << "Heaviest subtrees:\n";
+  for (auto const& [lv, tree] : heaviest) {
+    ss << "  " << std::left << std::setw(32) << lv->GetName() << std::right << std::setw(12) << kB(tree.bytes)
+       << std::setw(10) << tree.touchables << " touchables\n";
+  }
+  mf::LogInfo("GeometryReport") << ss.str();
+
+  // -- JSON
+  if (fJsonFile.empty()) return;
+  std::ofstream out(fJsonFile);
+  if (!out) {
+    MF_LOG_WARNING("GeometryReport") << "Cannot write the geometry report file " << fJsonFile;
+    return;
+  }
+  out << "{\n"
+      << "  \"solids\": { \"count\": " << solids->size() << ", \"bytes\": " << solidTotal << ", \"facets\": " << facets << " },\n"
+      << "  \"logicalVolumes\": { \"count\": " << lvs->size() << ", \"bytes\": " << lvTotal << " },\n"
+      << "  \"physicalVolumes\": { \"count\": " << pvs->size() << ", \"bytes\": " << pvTotal << ", \"rotated\": " << rotations << " },\n"
+      << "  \"voxelHeaders\": { \"count\": " << nVoxelHeaders << ", \"bytes\": " << voxelTotal << " },\n"
+      << "  \"touchables\": " << touchables << ",\n"
+      << "  \"mothers\": [";
+  for (std::size_t i = 0; i < mothers.size(); ++i) {
+    out << (i ? "," : "") << "\n    { \"volume\": " << jsonString(mothers[i].first->GetName())
+        << ", \"daughters\": " << mothers[i].second << " }";
+  }
+  out << "\n  ],\n  \"voxels\": [";
+  for (std::size_t i = 0; i < voxels.size(); ++i) {
+    out << (i ? "," : "") << "\n    { \"volume\": " << jsonString(voxels[i].first->GetName())
+        << ", \"bytes\": " << voxels[i].second << " }";
+  }
+  out << "\n  ],\n  \"subtrees\": [";
+  for (std::size_t i = 0; i < heaviest.size(); ++i) {
+    out << (i ? "," : "") << "\n    { \"volume\": " << jsonString(heaviest[i].first->GetName())
+        << ", \"bytes\": " << heaviest[i].second.bytes << ", \"touchables\": " << heaviest[i].second.touchables << " }";
+  }
+  out << "\n  ]\n}\n";
+}
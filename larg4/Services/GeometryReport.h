@@ -0,0 +1,47 @@
+//=============================================================================
+// GeometryReport.h: memory footprint and complexity of the geometry, to find
+// the GDML sections worth simplifying.
+//
+// The report lists the number of solids, logical and physical volumes with an
+// estimate of their memory (from the size of the Geant4 classes, plus the
+// facets of tessellated solids and the rotation matrices), the memory of the
+// voxel headers built for the navigation, the mothers with most daughters and
+// the heaviest subtrees. The memory of a subtree includes all the volumes
+// below it; volumes shared by several subtrees are counted in each of them.
+// The number of touchables is the number of volumes in the expanded tree
+// (replicas and parameterised volumes counted once per copy).
+//
+// It is written to the log and, optionally, to a JSON file. It is configured
+// in LArG4DetectorService with
+//
+//   GeometryReport: {
+//     nTop:     10                       // entries in the top lists
+//     jsonFile: "geometry_report.json"   // empty for the log only
+//   }
+//=============================================================================
+#ifndef GeometryReport_h
+#define GeometryReport_h 1
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <string>
+
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  class GeometryReport {
+  public:
+    explicit GeometryReport(fhicl::ParameterSet const& p);
+
+    // Build the report of the geometry below the world volume, and write it
+    void write(G4VPhysicalVolume* world) const;
+
+  private:
+    unsigned    fNTop;
+    std::string fJsonFile;
+  };
+
+}   // namespace larg4
+
+#endif
@@ -26,21 +26,11 @@
 #include "larg4/Services/LArG4Detector_service.h"
 // artg4tk includes:
 #include "artg4tk/pluginDetectors/gdml/ColorReader.hh"
-#include "artg4tk/pluginDetectors/gdml/CalorimeterSD.hh"
-#include "artg4tk/pluginDetectors/gdml/CalorimeterHit.hh"
-#include "artg4tk/pluginDetectors/gdml/DRCalorimeterSD.hh"
-#include "artg4tk/pluginDetectors/gdml/DRCalorimeterHit.hh"
-#include "artg4tk/pluginDetectors/gdml/ByParticle.hh"
-#include "artg4tk/pluginDetectors/gdml/PhotonSD.hh"
-#include "artg4tk/pluginDetectors/gdml/PhotonHit.hh"
-#include "artg4tk/pluginDetectors/gdml/TrackerSD.hh"
-#include "artg4tk/pluginDetectors/gdml/TrackerHit.hh"
-#include "larg4/Services/SimEnergyDepositSD.h"
-#include "lardataobj/Simulation/SimEnergyDeposit.h"
-#include "larg4/Services/AuxDetSD.h"
-#include "lardataobj/Simulation/AuxDetHit.h"
-#include "artg4tk/pluginDetectors/gdml/HadInteractionSD.hh"
-#include "artg4tk/pluginDetectors/gdml/HadIntAndEdepTrkSD.hh"
+#include "artg4tk/services/DetectorHolder_service.hh"
+#include "larg4/Services/SensitiveDetectorRegistry.h"
+#include "larg4/Services/WoodcockTrackingModel.h"
+#include "larg4/Services/OverburdenMuonModel.h"
+#include "larg4/Services/GDMLFiles.h"
 //
 // Geant 4 includes:
 #include "Geant4/G4SDManager.hh"
@@ -54,11 +44,17 @@
 #include "Geant4/G4UserLimits.hh"
 #include "Geant4/G4UnitsTable.hh"
 #include "Geant4/G4StepLimiter.hh"
+#include "Geant4/G4EmParameters.hh"
+#include "Geant4/G4Region.hh"
 #include "Geant4/G4RegionStore.hh"
+#include "Geant4/G4ProductionCutsTable.hh"
 #include "Geant4/G4Types.hh"
 #include "Geant4/G4AutoDelete.hh"
 
 // C++ includes
+#include <algorithm>
+#include <functional>
+#include <set>
 #include <unordered_map>
 using std::string;
 
@@ -83,15 +79,23 @@ larg4::LArG4DetectorService::LArG4DetectorService(fhicl::ParameterSet const & p)
                         p.get<string>("mother_category", "")),
   gdmlFileName_( p.get<std::string>("gdmlFileName_","")),
   checkoverlaps_( p.get<bool>("CheckOverlaps",false)),
+  validateGDML_( p.get<bool>("ValidateGDML",true)),
+  gdmlThreads_( p.get<unsigned>("GDMLThreads",1)),
   volumeNames_( p.get<std::vector<std::string>>("volumeNames",{}) ),
   stepLimits_( p.get<std::vector<float>>("stepLimits",{}) ),
   inputVolumes_(0),
   dumpMP_( p.get<bool>("DumpMaterialProperties",false)),
+  productInstancePrefix_( p.get<std::string>("productInstancePrefix","")),
+  emRegions_( p.get<std::vector<std::string>>("emRegions",{}) ),
+  emPhysics_( p.get<std::vector<std::string>>("emPhysics",{}) ),
+  keepVolumes_( p.get<std::vector<std::string>>("keepVolumes",{}) ),
+  dropPrunedVolumes_( p.get<bool>("dropPrunedVolumes",false) ),
   logInfo_( "LArG4DetectorService" ),
-  DetectorList(0)
+  worldPV_(nullptr)
 {
   setGDMLVolumes_.clear();
   overrideGDMLStepLimit_Map.clear();
+  importanceMap_.clear();
   // Make sure units are defined.
      G4UnitDefinition::GetUnitsTable();
   // -- D.R. : Check for valid volume, steplimit pairs
@@ -100,6 +104,11 @@ larg4::LArG4DetectorService::LArG4DetectorService(fhicl::ParameterSet const & p)
                                                  << " stepLimits:[] have different sizes!" << "\n";
   }
 
+  if(emRegions_.size() != emPhysics_.size()) {
+    throw cet::exception("LArG4DetectorService") << "Configuration error: emRegions:[] and"
+                                                 << " emPhysics:[] have different sizes!" << "\n";
+  }
+
   inputVolumes_ = volumeNames_.size();
 
   //-- define commonly used units, that we might need
@@ -118,6 +127,66 @@ larg4::LArG4DetectorService::LArG4DetectorService(fhicl::ParameterSet const & p)
                                                << ", stepLimit: " << stepLimits_.at(i);
     }//--check for negative
   } //--loop over inputVolumes
+
+  // -- step limits by particle species and kinetic energy
+  for (auto const& volumePSet : p.get<std::vector<fhicl::ParameterSet>>("speciesStepLimits", {})) {
+    std::string const volumeName = volumePSet.get<std::string>("volume");
+    auto& entries = speciesStepLimits_[volumeName];
+    for (auto const& limitPSet : volumePSet.get<std::vector<fhicl::ParameterSet>>("limits")) {
+      SpeciesStepLimits::Entry_t entry;
+      entry.pdgs      = limitPSet.get<std::vector<int>>("pdgs", {});
+      entry.minEnergy = limitPSet.get<double>("minEnergy", 0.) * CLHEP::MeV;
+      entry.maxEnergy = limitPSet.get<double>("maxEnergy", DBL_MAX / CLHEP::MeV) * CLHEP::MeV;
+      entry.maxStep   = limitPSet.get<double>("maxStep") * CLHEP::mm;
+      if (entry.maxStep <= 0. || entry.maxEnergy <= entry.minEnergy) {
+        throw cet::exception("LArG4DetectorService") << "Invalid speciesStepLimits entry for volume "
+                                                     << volumeName << ": maxStep must be positive and"
+                                                     << " maxEnergy larger than minEnergy.\n";
+      }
+      entries.push_back(entry);
+    }
+  }
+
+  // -- parallel, cached overlap check of the whole geometry
+  if (fhicl::ParameterSet overlapPSet; p.get_if_present("OverlapCheck", overlapPSet)) {
+    overlapChecker_ = std::make_unique<OverlapChecker>(overlapPSet);
+  }
+
+  // -- collapse the arrays of identical placements into replicas/parameterised volumes
+  if (fhicl::ParameterSet collapsePSet; p.get_if_present("CollapsePlacements", collapsePSet)) {
+    placementCollapser_ = std::make_unique<PlacementCollapser>(collapsePSet);
+    geometryModifiers_ += "CollapsePlacements:" + collapsePSet.to_compact_string() + "\n";
+  }
+  if (!keepVolumes_.empty()) {
+    geometryModifiers_ += "dropPrunedVolumes:" + std::to_string(dropPrunedVolumes_) + " keepVolumes:";
+    for (auto const& name : keepVolumes_) geometryModifiers_ += " " + name;
+    geometryModifiers_ += "\n";
+  }
+
+  // -- voxelization of the navigation per volume, overriding the GDML file
+  for (auto const& voxelPSet : p.get<std::vector<fhicl::ParameterSet>>("voxelSettings", {})) {
+    VoxelSettings_t settings;
+    if (G4double smartless; voxelPSet.get_if_present("smartless", smartless)) {
+      if (smartless <= 0.) {
+        throw cet::exception("LArG4DetectorService") << "Invalid voxelSettings entry for volume "
+                                                     << voxelPSet.get<std::string>("volume")
+                                                     << ": smartless must be positive.\n";
+      }
+      settings.smartless = smartless;
+    }
+    if (bool optimise; voxelPSet.get_if_present("optimise", optimise)) {
+      settings.optimise = optimise;
+    }
+    voxelSettings_[voxelPSet.get<std::string>("volume")] = settings;
+  }
+
+  if (fhicl::ParameterSet benchmarkPSet; p.get_if_present("NavigationBenchmark", benchmarkPSet)) {
+    navigationBenchmark_ = std::make_unique<NavigationBenchmark>(benchmarkPSet);
+  }
+
+  if (fhicl::ParameterSet reportPSet; p.get_if_present("GeometryReport", reportPSet)) {
+    geometryReport_ = std::make_unique<GeometryReport>(reportPSet);
+  }
 }//--Ctor
 
 // Destructor
@@ -134,8 +203,33 @@ std::vector<G4LogicalVolume *> larg4::LArG4DetectorService::doBuildLVs() {
     if (!sp.find_file(gdmlFileName_, fullGDMLFileName)) {
       throw cet::exception("LArG4DetectorService") << "Cannot find file: " << gdmlFileName_;
     }
-    parser.Read(fullGDMLFileName);
+    if (validateGDML_ && gdmlThreads_ > 1) {
+      // -- the Geant4 stores are not thread safe, but the schema validation of the
+      //    main file and of its modules, which dominates the parsing time, can be
+      //    done concurrently before a single parse without validation
+      auto const gdmlFiles = listGDMLFiles(fullGDMLFileName);
+      for (auto const& message : validateGDMLFiles(gdmlFiles, gdmlThreads_)) {
+        MF_LOG_WARNING("LArG4DetectorService::doBuildLVs") << message;
+      }
+      mf::LogInfo("LArG4DetectorService::doBuildLVs") << "Validated " << gdmlFiles.size()
+                                                     << " gdml file(s) on " << gdmlThreads_ << " threads.";
+      parser.Read(fullGDMLFileName, false);
+    } else {
+      parser.Read(fullGDMLFileName, validateGDML_);
+    }
     G4VPhysicalVolume *World = parser.GetWorldVolume();
+    worldPV_ = World;
+    const G4GDMLAuxMapType* auxmap = parser.GetAuxMap();
+    G4GDMLAuxMapType prunedAuxmap;
+    if (!keepVolumes_.empty()) {
+      // -- the auxiliary information of the pruned volumes (regions, sensitive
+      //    detectors, importances, models...) must not be applied
+      auto const built = pruneGeometry(World->GetLogicalVolume());
+      for (auto const& entry : *auxmap) {
+        if (built.count(entry.first)) prunedAuxmap.insert(entry);
+      }
+      auxmap = &prunedAuxmap;
+    }
 
     std::stringstream ss;
     ss << World->GetTranslation() << "\n\n";
@@ -150,13 +244,26 @@ std::vector<G4LogicalVolume *> larg4::LArG4DetectorService::doBuildLVs() {
        << " physical volumes."
        << "\n\n";
     G4SDManager* SDman = G4SDManager::GetSDMpointer();
-    const G4GDMLAuxMapType* auxmap = parser.GetAuxMap();
     ss << "Found " << auxmap->size()
        << " volume(s) with auxiliary information."
        << "\n\n";
     ss << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%\n";
     mf::LogInfo("LArG4DetectorService::doBuildLVs") << ss.str();
 
+    if (overlapChecker_) {
+      checkOverlaps(World, fullGDMLFileName);
+    }
+
+    // -- regions first, so that the models attached to a region below find it
+    for (auto const& [lv, auxlist] : *auxmap) {
+        for (auto const& aux : auxlist) {
+            if (aux.type != "Region") continue;
+            regionForVolume(lv, aux.value);
+            mf::LogInfo("LArG4DetectorService::doBuildLVs") << "Volume " << lv->GetName()
+                                                           << " added to region " << aux.value;
+        }
+    }
+
     for (G4GDMLAuxMapType::const_iterator iter = auxmap->begin();
         iter != auxmap->end(); iter++)
     {
@@ -206,74 +313,118 @@ std::vector<G4LogicalVolume *> larg4::LArG4DetectorService::doBuildLVs() {
                         << " from the GDML file.";
                 setGDMLVolumes_.insert(std::make_pair( ((*iter).first)->GetName(), (float)(value/CLHEP::mm) ));
             }
+            if ((*vit).type == "Importance") {
+                // -- importance used for splitting/Russian roulette at the volume boundaries
+                if (value <= 0.) {
+                  throw cet::exception("LArG4DetectorService") << "Invalid Importance found for volume "
+                                                               << ((*iter).first)->GetName()
+                                                               << ". Importances must be positive! Bad value : "
+                                                               << value << "\n";
+                }
+                importanceMap_[(*iter).first] = value;
+                mf::LogInfo("LArG4DetectorService::doBuildLVs") << "Importance: " << value
+                                                               << " for volume: " << ((*iter).first)->GetName();
+            }
+            if ((*vit).type == "WoodcockTracking") {
+                // -- Woodcock tracking of photons through the whole volume, including its daughters
+                if ((*iter).first == World->GetLogicalVolume()) {
+                  throw cet::exception("LArG4DetectorService") << "WoodcockTracking cannot be enabled for"
+                                                               << " the world volume!\n";
+                }
+                // -- the model samples the individual photon processes, which do not exist when they are
+                //    combined in G4GammaGeneralProcess (the default of recent standard EM constructors);
+                //    the geometry is built before the physics list, so this still takes effect
+                if (G4EmParameters::Instance()->GeneralProcessActive()) {
+                  MF_LOG_WARNING("LArG4DetectorService::doBuildLVs") << "WoodcockTracking needs the individual photon"
+                                                                     << " processes: disabling G4GammaGeneralProcess.";
+                  G4EmParameters::Instance()->SetGeneralProcessActive(false);
+                }
+                G4String name = ((*iter).first)->GetName() + "_WoodcockTracking";
+                G4Region* region = regionForVolume((*iter).first, ((*iter).first)->GetName() + "_Region");
+                WoodcockTrackingModel* aWoodcockModel = new WoodcockTrackingModel(name, region, (*iter).first);
+                G4AutoDelete::Register(aWoodcockModel);
+                if (std::find(fastSimParticles_.begin(), fastSimParticles_.end(), "gamma") == fastSimParticles_.end()) {
+                  fastSimParticles_.push_back("gamma");
+                }
+                mf::LogInfo("LArG4DetectorService::doBuildLVs") << "Woodcock tracking of photons enabled"
+                                                               << " for volume: " << ((*iter).first)->GetName();
+            }
+            if ((*vit).type == "Overburden") {
+                // -- single step muon propagation through the volume, the value is the minimum kinetic energy
+                G4double minKineticEnergy = value;
+                if (provided_category == "NONE") { //--no unit category provided, use GeV
+                  MF_LOG_WARNING("OverburdenUnit") << "Overburden in geometry file does not have a unit!"
+                                                   << " Defaulting to GeV...";
+                  minKineticEnergy *= CLHEP::GeV;
+                } else if (provided_category != "Energy") {
+                  throw cet::exception("OverburdenUnit") << "Overburden does not have a valid energy unit!\n"
+                                                         << " Category of unit provided = " << provided_category << ".\n";
+                }
+                G4String name = ((*iter).first)->GetName() + "_Overburden";
+                // -- the region must only cover the overburden volume: its daughters (e.g. the hall)
+                // -- are put back in the region they had, or in a region of their own
+                G4Region* outerRegion = ((*iter).first)->GetRegion();
+                G4Region* region = regionForVolume((*iter).first, ((*iter).first)->GetName() + "_Region");
+                for (size_t i = 0; i < ((*iter).first)->GetNoDaughters(); ++i) {
+                  G4LogicalVolume* daughter = ((*iter).first)->GetDaughter(i)->GetLogicalVolume();
+                  if (daughter->IsRootRegion()) continue;
+                  if (outerRegion && outerRegion != region) {
+                    outerRegion->AddRootLogicalVolume(daughter);
+                  } else {
+                    regionForVolume(daughter, ((*iter).first)->GetName() + "_Daughters_Region");
+                  }
+                }
+                OverburdenMuonModel* anOverburdenModel = new OverburdenMuonModel(name, region, (*iter).first, minKineticEnergy);
+                G4AutoDelete::Register(anOverburdenModel);
+                for (std::string const muon : {"mu-", "mu+"}) {
+                  if (std::find(fastSimParticles_.begin(), fastSimParticles_.end(), muon) == fastSimParticles_.end()) {
+                    fastSimParticles_.push_back(muon);
+                  }
+                }
+            }
+            if ((*vit).type == "Smartless") {
+                // -- average number of voxel slices per daughter (Geant4 default: 2)
+                if (value <= 0.) {
+                  throw cet::exception("LArG4DetectorService") << "Invalid Smartless found for volume "
+                                                               << ((*iter).first)->GetName()
+                                                               << ". Smartless must be positive! Bad value : "
+                                                               << value << "\n";
+                }
+                ((*iter).first)->SetSmartless(value);
+                mf::LogInfo("LArG4DetectorService::doBuildLVs") << "Smartless: " << value
+                                                               << " for volume: " << ((*iter).first)->GetName();
+            }
+            if ((*vit).type == "Optimise") {
+                // -- voxelization of the daughters, "false" to disable it
+                G4bool optimise = ((*vit).value != "false" && (*vit).value != "0");
+                ((*iter).first)->SetOptimisation(optimise);
+                mf::LogInfo("LArG4DetectorService::doBuildLVs") << "Optimise: " << optimise
+                                                               << " for volume: " << ((*iter).first)->GetName();
+            }
             if ((*vit).type == "SensDet") {
-                if ((*vit).value == "DRCalorimeter") {
-                    G4String name = ((*iter).first)->GetName() + "_DRCalorimeter";
-                    artg4tk::DRCalorimeterSD* aDRCalorimeterSD = new artg4tk::DRCalorimeterSD(name);
-                    SDman->AddNewDetector(aDRCalorimeterSD);
-                    ((*iter).first)->SetSensitiveDetector(aDRCalorimeterSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "Calorimeter") {
-                    G4String name = ((*iter).first)->GetName() + "_Calorimeter";
-                    artg4tk::CalorimeterSD* aCalorimeterSD = new artg4tk::CalorimeterSD(name);
-                    SDman->AddNewDetector(aCalorimeterSD);
-                    ((*iter).first)->SetSensitiveDetector(aCalorimeterSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "PhotonDetector") {
-                    G4String name = ((*iter).first)->GetName() + "_PhotonDetector";
-                    artg4tk::PhotonSD* aPhotonSD = new artg4tk::PhotonSD(name);
-                    SDman->AddNewDetector(aPhotonSD);
-                    ((*iter).first)->SetSensitiveDetector(aPhotonSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "Tracker") {
-                    G4String name = ((*iter).first)->GetName() + "_Tracker";
-                    artg4tk::TrackerSD* aTrackerSD = new artg4tk::TrackerSD(name);
-                    SDman->AddNewDetector(aTrackerSD);
-                    ((*iter).first)->SetSensitiveDetector(aTrackerSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "SimEnergyDeposit") {
-                    G4String name = ((*iter).first)->GetName() + "_SimEnergyDeposit";
-                    SimEnergyDepositSD * aSimEnergyDepositSD = new SimEnergyDepositSD(name);
-                    SDman->AddNewDetector(aSimEnergyDepositSD);
-                    ((*iter).first)->SetSensitiveDetector(aSimEnergyDepositSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "AuxDet") {
-                    G4String name = ((*iter).first)->GetName() + "_AuxDet";
-                    AuxDetSD * aAuxDetSD = new AuxDetSD(name);
-                    SDman->AddNewDetector(aAuxDetSD);
-                    ((*iter).first)->SetSensitiveDetector(aAuxDetSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "HadInteraction") {
-                    G4String name = ((*iter).first)->GetName() + "_HadInteraction";
-                    artg4tk::HadInteractionSD* aHadInteractionSD = new artg4tk::HadInteractionSD(name);
-                    // NOTE: This will be done in the HadInteractionSD ctor
-                    // SDman->AddNewDetector(aHadInteractionSD);
-                    ((*iter).first)->SetSensitiveDetector(aHadInteractionSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
-                } else if ((*vit).value == "HadIntAndEdepTrk") {
-                    G4String name = ((*iter).first)->GetName() + "_HadIntAndEdepTrk";
-                    artg4tk::HadIntAndEdepTrkSD* aHadIntAndEdepTrkSD = new artg4tk::HadIntAndEdepTrkSD(name);
-                    // NOTE: This will be done in the HadIntAndEdepTrkSD ctor
-                    // SDman->AddNewDetector(aHadIntAndEdepTrkSD);
-                    ((*iter).first)->SetSensitiveDetector(aHadIntAndEdepTrkSD);
-                    std::cout << "Attaching sensitive Detector: " << (*vit).value
-                            << " to Volume:  " << ((*iter).first)->GetName() << "\n";
-                    DetectorList.push_back(std::make_pair((*iter).first->GetName(), (*vit).value));
+                // -- the type selects the factory in the registry, which may load a plugin library;
+                //    as before the registry, a volume with an unknown type gets no sensitive detector
+                SensitiveDetectorRegistry::Factory_t const* found = nullptr;
+                try {
+                  found = &SensitiveDetectorRegistry::instance().get((*vit).value);
+                }
+                catch (cet::exception& e) {
+                  MF_LOG_WARNING("LArG4DetectorService::doBuildLVs") << "No sensitive detector attached to volume "
+                                                                     << ((*iter).first)->GetName() << ":\n"
+                                                                     << e.what();
+                  continue;
                 }
+                auto const& factory = *found;
+                G4String name = ((*iter).first)->GetName() + "_" + (*vit).value;
+                G4VSensitiveDetector* aSD = factory.create(name);
+                ((*iter).first)->SetSensitiveDetector(aSD);
+                std::cout << "Attaching sensitive Detector: " << (*vit).value
+                        << " to Volume:  " << ((*iter).first)->GetName() << "\n";
+                // -- a common prefix lets the output modules route or drop all the hit collections at once,
+                //    including those of the types whose products are not named after the volume
+                std::string instance = productInstancePrefix_;
+                if (factory.perVolume) instance += myName() + ((*iter).first)->GetName();
+                sdHandlers_.push_back({&factory, aSD, instance});
             }
         }
         std::cout << "%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%\n";
@@ -285,6 +436,29 @@ std::vector<G4LogicalVolume *> larg4::LArG4DetectorService::doBuildLVs() {
     if (inputVolumes_ > 0) {
       setStepLimits();
     }
+    if (!speciesStepLimits_.empty()) {
+      setSpeciesStepLimits();
+    }
+    if (!emRegions_.empty()) {
+      setRegionEmPhysics();
+    }
+    if (!voxelSettings_.empty()) {
+      setVoxelSettings();
+    }
+    if (placementCollapser_) {
+      // -- envelopes take the place of their mother for importance biasing
+      for (auto const& [envelope, mother] : placementCollapser_->collapse(World)) {
+        if (auto search = importanceMap_.find(mother); search != importanceMap_.end()) {
+          importanceMap_[envelope] = search->second;
+        }
+      }
+    }
+    if (navigationBenchmark_) {
+      navigationBenchmark_->report(navigationBenchmark_->run(World));
+    }
+    if (geometryReport_) {
+      geometryReport_->write(World);
+    }
     std::cout << "List SD Tree: \n";
     SDman->ListTree();
     std::cout << " Collection Capacity:  " << SDman->GetCollectionCapacity() << "\n";
@@ -295,7 +469,7 @@ std::vector<G4LogicalVolume *> larg4::LArG4DetectorService::doBuildLVs() {
     std::cout << "==================================================\n";
     // Return our logical volumes.
     std::vector<G4LogicalVolume *> myLVvec;
-    myLVvec.push_back(pLVStore->at(0)); // only need to return the LV of the world
+    myLVvec.push_back(World->GetLogicalVolume()); // only need to return the LV of the world
     std::cout << "nr of LV ======================:  " << myLVvec.size() << "\n";
 
     return myLVvec;
@@ -304,8 +478,9 @@ std::vector<G4LogicalVolume *> larg4::LArG4DetectorService::doBuildLVs() {
 std::vector<G4VPhysicalVolume *> larg4::LArG4DetectorService::doPlaceToPVs(std::vector<G4LogicalVolume *>) {
     // Note we don't use our input.
     std::vector<G4VPhysicalVolume *> myPVvec;
-    G4PhysicalVolumeStore *pPVStore = G4PhysicalVolumeStore::GetInstance();
-    myPVvec.push_back(pPVStore->at(pPVStore->size() - 1)); // only need to return the PV of the world  (last entry in Volume Store)
+    // only need to return the PV of the world: not the last entry in the volume store
+    // anymore once placements have been collapsed
+    myPVvec.push_back(worldPV_);
     return myPVvec;
 }
 
@@ -366,152 +541,200 @@ void larg4::LArG4DetectorService::setStepLimits() {
   }//--loop over input volumes
 }//--end of setStepLimit()
 
+G4Region* larg4::LArG4DetectorService::regionForVolume(G4LogicalVolume* lv, std::string const& regionName) {
+  // -- a volume can be the root of one region only: reuse it if it exists already
+  if (lv->IsRootRegion()) return lv->GetRegion();
+  // -- several volumes can share a region
+  G4Region* region = G4RegionStore::GetInstance()->GetRegion(regionName, false);
+  if (!region) {
+    region = new G4Region(regionName);
+    // -- the production cuts of the world, shared so that they follow the cuts set by the physics
+    //    list later on (a region without cuts gets a warning from Geant4 at each run)
+    region->SetProductionCuts(G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts());
+  }
+  region->AddRootLogicalVolume(lv);
+  return region;
+}
+
+void larg4::LArG4DetectorService::setSpeciesStepLimits() {
+  for (auto const& [name, entries] : speciesStepLimits_) {
+    G4LogicalVolume* setVol = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!setVol) {
+      throw cet::exception("invalidInputVolumeName")
+        << "Provided volume name : " << name << " not found!\n";
+    }
+
+    // -- tracks not matching any entry keep the step limit from the configuration or GDML file
+    G4double defaultMaxStep = DBL_MAX;
+    if (auto search = overrideGDMLStepLimit_Map.find(name); search != overrideGDMLStepLimit_Map.end()) {
+      defaultMaxStep = search->second;
+    } else if (auto search = setGDMLVolumes_.find(name); search != setGDMLVolumes_.end()) {
+      defaultMaxStep = search->second * CLHEP::mm;
+    }
+
+    SpeciesStepLimits* fSpeciesStepLimit = new SpeciesStepLimits(defaultMaxStep, entries);
+    G4AutoDelete::Register(fSpeciesStepLimit);
+    setVol->SetUserLimits(fSpeciesStepLimit);
+
+    std::stringstream ss;
+    ss << "Step limits by species for volume: " << name << " (default: " << defaultMaxStep / CLHEP::mm << " mm)";
+    for (auto const& entry : entries) {
+      ss << "\n\tPDG [";
+      for (int pdg : entry.pdgs) ss << " " << pdg;
+      ss << " ] " << entry.minEnergy / CLHEP::MeV << " - " << entry.maxEnergy / CLHEP::MeV
+         << " MeV : " << entry.maxStep / CLHEP::mm << " mm";
+    }
+    mf::LogInfo("LArG4DetectorService::setSpeciesStepLimits") << ss.str();
+  }
+}
+
+void larg4::LArG4DetectorService::setRegionEmPhysics() {
+  // -- types understood by G4EmModelActivator
+  static std::vector<std::string> const knownTypes{
+    "G4EmStandard", "G4EmStandard_opt1", "G4EmStandard_opt2", "G4EmStandard_opt3", "G4EmStandard_opt4",
+    "G4EmStandardGS", "G4EmStandardSS", "G4EmStandardWVI", "G4EmLivermore", "G4EmPenelope", "G4EmLowEP"};
+
+  G4EmParameters* emParameters = G4EmParameters::Instance();
+  for (size_t i = 0; i < emRegions_.size(); ++i) {
+    if (!G4RegionStore::GetInstance()->GetRegion(emRegions_[i], false)) {
+      throw cet::exception("invalidEmRegionName") << "Provided region name : " << emRegions_[i]
+                                                  << " not found! Regions are defined with the"
+                                                  << " \"Region\" auxiliary tag in the GDML file.\n";
+    }
+    if (std::find(knownTypes.begin(), knownTypes.end(), emPhysics_[i]) == knownTypes.end()) {
+      throw cet::exception("invalidEmPhysics") << "Unknown EM physics type : " << emPhysics_[i]
+                                               << " for region " << emRegions_[i] << "\n";
+    }
+    emParameters->AddPhysics(emRegions_[i], emPhysics_[i]);
+    mf::LogInfo("LArG4DetectorService::setRegionEmPhysics") << "EM physics " << emPhysics_[i]
+                                                           << " for region " << emRegions_[i];
+  }
+}
+
+std::set<G4LogicalVolume const*> larg4::LArG4DetectorService::pruneGeometry(G4LogicalVolume* world) {
+  std::set<G4LogicalVolume const*> kept;
+  for (auto const& name : keepVolumes_) {
+    G4LogicalVolume* keepVol = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!keepVol) {
+      throw cet::exception("invalidInputVolumeName")
+        << "Provided volume name : " << name << " not found!\n";
+    }
+    kept.insert(keepVol);
+  }
+
+  // -- volumes leading to a kept volume, which are built with all their daughters
+  std::map<G4LogicalVolume const*, bool> leadsToKept;
+  std::function<bool(G4LogicalVolume const*)> leads = [&](G4LogicalVolume const* lv) {
+    if (auto search = leadsToKept.find(lv); search != leadsToKept.end()) return search->second;
+    bool result = kept.count(lv) > 0;
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+      if (leads(lv->GetDaughter(i)->GetLogicalVolume())) result = true;
+    }
+    return leadsToKept[lv] = result;
+  };
+  leads(world);
+
+  std::map<G4LogicalVolume*, G4LogicalVolume*> placeholders;
+  std::set<G4LogicalVolume*> visited;
+  size_t nPruned = 0;
+  std::function<void(G4LogicalVolume*)> prune = [&](G4LogicalVolume* lv) {
+    if (kept.count(lv) || !visited.insert(lv).second) return;
+    std::vector<G4VPhysicalVolume*> others;
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+      G4VPhysicalVolume* daughter = lv->GetDaughter(i);
+      if (leadsToKept[daughter->GetLogicalVolume()]) prune(daughter->GetLogicalVolume());
+      else others.push_back(daughter);
+    }
+    for (G4VPhysicalVolume* daughter : others) {
+      ++nPruned;
+      if (dropPrunedVolumes_) {
+        lv->RemoveDaughter(daughter);
+        delete daughter;
+        continue;
+      }
+      // -- one placeholder per logical volume, shared by all its placements
+      G4LogicalVolume* original = daughter->GetLogicalVolume();
+      G4LogicalVolume*& placeholder = placeholders[original];
+      if (!placeholder) {
+        placeholder = new G4LogicalVolume(original->GetSolid(), original->GetMaterial(),
+                                          original->GetName() + "_Placeholder");
+        placeholder->SetVisAttributes(original->GetVisAttributes());
+      }
+      daughter->SetLogicalVolume(placeholder);
+    }
+  };
+  prune(world);
+
+  mf::LogInfo("LArG4DetectorService::pruneGeometry") << (dropPrunedVolumes_ ? "Removed " : "Emptied ")
+                                                    << nPruned << " placement(s) not leading to"
+                                                    << " any of the " << keepVolumes_.size()
+                                                    << " volume(s) to keep.";
+
+  std::set<G4LogicalVolume const*> built;
+  std::function<void(G4LogicalVolume const*)> collect = [&](G4LogicalVolume const* lv) {
+    if (!built.insert(lv).second) return;
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) collect(lv->GetDaughter(i)->GetLogicalVolume());
+  };
+  collect(world);
+  return built;
+}
+
+void larg4::LArG4DetectorService::setVoxelSettings() {
+  for (auto const& [name, settings] : voxelSettings_) {
+    G4LogicalVolume* setVol = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!setVol) {
+      throw cet::exception("invalidInputVolumeName")
+        << "Provided volume name : " << name << " not found!\n";
+    }
+    if (settings.smartless) setVol->SetSmartless(*settings.smartless);
+    if (settings.optimise) setVol->SetOptimisation(*settings.optimise);
+    mf::LogInfo("LArG4DetectorService::setVoxelSettings") << "Volume: " << name
+                                                         << ", smartless: " << setVol->GetSmartless()
+                                                         << ", optimise: " << setVol->IsToOptimise();
+  }
+}
+
+void larg4::LArG4DetectorService::checkOverlaps(G4VPhysicalVolume const* world, std::string const& gdmlFile) {
+  // -- the hash covers the main GDML file and all the files it references, and the
+  //    settings which modify the tree read from them
+  std::uint64_t const geometryHash = hashString(geometryModifiers_, hashFiles(listGDMLFiles(gdmlFile)));
+  auto const results = overlapChecker_->check(world, geometryHash);
+
+  size_t nOverlaps = 0;
+  for (auto const& result : results) {
+    if (!result.overlaps) continue;
+    ++nOverlaps;
+    MF_LOG_WARNING("LArG4DetectorService::checkOverlaps") << "Volume " << result.volume
+                                                         << " (copy " << result.copyNo << ")"
+                                                         << result.description;
+  }
+  mf::LogInfo("LArG4DetectorService::checkOverlaps") << "Checked " << results.size()
+                                                    << " placements for overlaps, found "
+                                                    << nOverlaps << " overlapping.";
+  if (nOverlaps > 0 && overlapChecker_->abortOnOverlap()) {
+    throw cet::exception("LArG4DetectorService") << "Found " << nOverlaps
+                                                 << " overlapping volume(s) in the geometry.\n";
+  }
+}
+
+G4double larg4::LArG4DetectorService::GetImportance(G4LogicalVolume const* lv) const {
+  auto search = importanceMap_.find(lv);
+  return (search == importanceMap_.end()) ? 1. : search->second;
+}
+
 void larg4::LArG4DetectorService::doCallArtProduces(art::ProducesCollector& collector) {
     // Tell Art what we produce, and label the entries
-    std::vector<std::pair<std::string, std::string> >::const_iterator cii;
-    for (cii = DetectorList.begin(); cii != DetectorList.end(); cii++) {
-        if ((*cii).second == "DRCalorimeter") {
-            std::string identifier = myName() +(*cii).first;
-            collector.produces<artg4tk::DRCalorimeterHitCollection>(identifier);
-            std::string EdepID = identifier + "Edep";
-            collector.produces<artg4tk::ByParticle>(EdepID);
-            std::string NCerenID = identifier + "NCeren";
-            collector.produces<artg4tk::ByParticle>(NCerenID);
-        } else if ((*cii).second == "Calorimeter") {
-            std::string identifier = myName() +(*cii).first;
-            collector.produces<artg4tk::CalorimeterHitCollection>(identifier);
-        } else if ((*cii).second == "PhotonDetector") {
-            std::string identifier = myName() + (*cii).first;
-            collector.produces<artg4tk::PhotonHitCollection>(identifier);
-        } else if ((*cii).second == "Tracker") {
-            std::string identifier = myName()+(*cii).first;
-            collector.produces<artg4tk::TrackerHitCollection>(identifier);
-        } else if ((*cii).second == "SimEnergyDeposit") {
-            std::string identifier = myName() + (*cii).first;
-            collector.produces<sim::SimEnergyDepositCollection>(identifier);
-        } else if ((*cii).second == "AuxDet") {
-            std::string identifier = myName() + (*cii).first;
-            collector.produces<sim::AuxDetHitCollection>(identifier);
-        } else if ((*cii).second == "HadInteraction") {
-            // std::string identifier = myName() + (*cii).first;
-            collector.produces<artg4tk::ArtG4tkVtx>(); // do NOT use product instance name (for now)
-        } else if ((*cii).second == "HadIntAndEdepTrk") {
-            collector.produces<artg4tk::ArtG4tkVtx>();
-            collector.produces<artg4tk::TrackerHitCollection>();
-        }
+    for (auto const& handler : sdHandlers_) {
+        handler.factory->produces(collector, handler.instance);
     }
 }
 
 void larg4::LArG4DetectorService::doFillEventWithArtHits(G4HCofThisEvent * myHC) {
-    //
-    // NOTE(JVY): 1st hadronic interaction will be fetched as-is from HadInteractionSD
-    //            a copy (via copy ctor) will be placed directly into art::Event
-    //
-    std::vector<std::pair<std::string, std::string> >::const_iterator cii;
-    //    std::cout << "****************Detectorlist size:  " << DetectorList.size() << std::endl;
-    for (cii = DetectorList.begin(); cii != DetectorList.end(); cii++) {
-        std::string sdname = (*cii).first + "_" + (*cii).second;
-        //  std::cout << "****************SDNAME:" << sdname << std::endl;
-        if ((*cii).second == "HadInteraction") {
-            G4SDManager* sdman = G4SDManager::GetSDMpointer();
-            artg4tk::HadInteractionSD* hisd = dynamic_cast<artg4tk::HadInteractionSD*> (sdman->FindSensitiveDetector(sdname));
-            if (hisd) {
-                const artg4tk::ArtG4tkVtx& inter = hisd->Get1stInteraction();
-                if (inter.GetNumOutcoming() > 0) {
-                    auto firstint = std::make_unique<artg4tk::ArtG4tkVtx>(inter);
-                    art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-                    art::Event & e = detectorHolder -> getCurrArtEvent();
-                    e.put(std::move(firstint)); // note that there's NO product instance name (for now, at least)
-                    // (part of) the is that the name is encoded into the "collection"
-                    // which is NOT used in this specific case
-                }
-                hisd->clear(); // clear out after movind info to EDM; no need to clea out in the producer !
-            }
-        } else if ((*cii).second == "HadIntAndEdepTrk") {
-            G4SDManager* sdman = G4SDManager::GetSDMpointer();
-            artg4tk::HadIntAndEdepTrkSD* sd = dynamic_cast<artg4tk::HadIntAndEdepTrkSD*> (sdman->FindSensitiveDetector(sdname));
-            if (sd) {
-                art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-                art::Event & e = detectorHolder -> getCurrArtEvent();
-                const artg4tk::ArtG4tkVtx& inter = sd->Get1stInteraction();
-                if (inter.GetNumOutcoming() > 0) {
-                    auto firstint = std::make_unique<artg4tk::ArtG4tkVtx>(inter);
-                    e.put(std::move(firstint)); // note that there's NO product instance name (for now, at least)
-                    // (part of) the is that the name is encoded into the "collection"
-                    // which is NOT used in this specific case
-                }
-                const artg4tk::TrackerHitCollection& trkhits = sd->GetEdepTrkHits();
-                if (!trkhits.empty()) {
-                    auto hits = std::make_unique<artg4tk::TrackerHitCollection>(trkhits);
-                    e.put(std::move(hits));
-                }
-                sd->clear(); // clear out after moving info to EDM; no need to clea out in the producer !
-            }
-        } else if ((*cii).second == "Tracker") {
-            G4SDManager* sdman = G4SDManager::GetSDMpointer();
-            artg4tk::TrackerSD* trsd = dynamic_cast<artg4tk::TrackerSD*> (sdman->FindSensitiveDetector(sdname));
-            art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-            art::Event & e = detectorHolder -> getCurrArtEvent();
-            const artg4tk::TrackerHitCollection& trkhits = trsd->GetHits();
-            auto hits = std::make_unique<artg4tk::TrackerHitCollection>(trkhits);
-            std::string identifier = myName()+(*cii).first;
-            e.put(std::move(hits), identifier);
-        }else if ( (*cii).second == "SimEnergyDeposit") {
-          G4SDManager* sdman = G4SDManager::GetSDMpointer();
-          SimEnergyDepositSD* sedsd = dynamic_cast<SimEnergyDepositSD*>(sdman->FindSensitiveDetector(sdname));
-          art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-          art::Event & e = detectorHolder -> getCurrArtEvent();
-          const sim::SimEnergyDepositCollection& sedhits = sedsd->GetHits();
-          auto hits = std::make_unique<sim::SimEnergyDepositCollection>(sedhits);
-          std::string identifier=myName()+(*cii).first;
-          e.put(std::move(hits), identifier);
-        } else if ( (*cii).second == "AuxDet") {
-          G4SDManager* sdman = G4SDManager::GetSDMpointer();
-          AuxDetSD* auxsd = dynamic_cast<AuxDetSD*>(sdman->FindSensitiveDetector(sdname));
-          art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-          art::Event & e = detectorHolder -> getCurrArtEvent();
-          const sim::AuxDetHitCollection& auxhits = auxsd->GetHits();
-          auto hits = std::make_unique<sim::AuxDetHitCollection>(auxhits);
-          std::string identifier=myName()+(*cii).first;
-          e.put(std::move(hits), identifier);
-        } else if ((*cii).second == "Calorimeter") {
-            G4SDManager* sdman = G4SDManager::GetSDMpointer();
-            artg4tk::CalorimeterSD* calsd = dynamic_cast<artg4tk::CalorimeterSD*> (sdman->FindSensitiveDetector(sdname));
-            art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-            art::Event & e = detectorHolder -> getCurrArtEvent();
-            const artg4tk::CalorimeterHitCollection& calhits = calsd->GetHits();
-            auto hits = std::make_unique<artg4tk::CalorimeterHitCollection>(calhits);
-            std::string identifier = myName()+(*cii).first;
-            e.put(std::move(hits), identifier);
-        } else if ((*cii).second == "DRCalorimeter") {
-            G4SDManager* sdman = G4SDManager::GetSDMpointer();
-            artg4tk::DRCalorimeterSD* drcalsd = dynamic_cast<artg4tk::DRCalorimeterSD*> (sdman->FindSensitiveDetector(sdname));
-            art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-            art::Event & e = detectorHolder -> getCurrArtEvent();
-            const artg4tk::DRCalorimeterHitCollection& drcalhits = drcalsd->GetHits();
-            auto hits = std::make_unique<artg4tk::DRCalorimeterHitCollection>(drcalhits);
-            std::string identifier = myName()+(*cii).first;
-            e.put(std::move(hits), identifier);
-            //
-            const artg4tk::ByParticle& edeps = drcalsd->GetEbyParticle();
-            auto edepsptr = std::make_unique<artg4tk::ByParticle>(edeps);
-            std::string edidentifier = myName()+(*cii).first + "Edep";
-            e.put(std::move(edepsptr), edidentifier);
-            //
-            const artg4tk::ByParticle& nceren = drcalsd->GetNCerenbyParticle();
-            auto ncerenptr = std::make_unique<artg4tk::ByParticle>(nceren);
-            std::string ncidentifier = myName()+(*cii).first + "NCeren";
-            e.put(std::move(ncerenptr), ncidentifier);
-        } else if ((*cii).second == "PhotonDetector") {
-            G4SDManager* sdman = G4SDManager::GetSDMpointer();
-            artg4tk::PhotonSD* phsd = dynamic_cast<artg4tk::PhotonSD*> (sdman->FindSensitiveDetector(sdname));
-            art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
-            art::Event & e = detectorHolder -> getCurrArtEvent();
-            const artg4tk::PhotonHitCollection& phhits = phsd->GetHits();
-            auto hits = std::make_unique<artg4tk::PhotonHitCollection>(phhits);
-            std::string identifier = myName()+(*cii).first;
-            e.put(std::move(hits), identifier);
-        }
+    // The SD pointers and product instance names were resolved in doBuildLVs
+    art::ServiceHandle<artg4tk::DetectorHolderService> detectorHolder;
+    art::Event & e = detectorHolder -> getCurrArtEvent();
+    for (auto const& handler : sdHandlers_) {
+        handler.factory->fill(handler.sd, e, handler.instance);
     }
 }
 using larg4::LArG4DetectorService;
@@ -44,16 +44,29 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <memory>
+#include <set>
+#include <optional>
 #include <unordered_map>
 #include "Geant4/G4LogicalVolume.hh"
 #include "Geant4/G4LogicalVolumeStore.hh"
 #include "Geant4/G4VPhysicalVolume.hh"
 #include "Geant4/G4GDMLParser.hh"
+#include "Geant4/G4Region.hh"
 
 // Get the base class
 #include "artg4tk/Core/DetectorBase.hh"
 
+#include "larg4/Services/SensitiveDetectorRegistry.h"
+#include "larg4/Services/SpeciesStepLimits.h"
+#include "larg4/Services/OverlapChecker.h"
+#include "larg4/Services/PlacementCollapser.h"
+#include "larg4/Services/NavigationBenchmark.h"
+#include "larg4/Services/GeometryReport.h"
+
 namespace art { class ProducesCollector; }
+class G4VSensitiveDetector;
 
 namespace larg4 {
 
@@ -61,22 +74,64 @@ namespace larg4 {
   private:
     std::string gdmlFileName_;              // name of the gdml file
     bool checkoverlaps_;                    // enable/disable check of overlaps
+    bool validateGDML_;                     // enable/disable validation of the gdml file(s) against the schema
+    unsigned gdmlThreads_;                  // threads validating the gdml files (1: validation by G4GDMLParser)
     std::vector<std::string> volumeNames_;  // list of volume names for which step limits should be set
     std::vector<float> stepLimits_;         // corresponding step limits to be set for each volume in the list of volumeNames, [mm]
     size_t inputVolumes_;                   // number of stepLimits to be set
     bool dumpMP_;                           // enable/disable dump of material properties
+    std::string productInstancePrefix_;     // prepended to the instance names of the sensitive detector products
+    std::vector<std::string> emRegions_;    // list of regions (GDML "Region" aux tag) with their own EM physics
+    std::vector<std::string> emPhysics_;    // corresponding G4EmParameters::AddPhysics type, e.g. "G4EmStandard_opt4"
+    std::vector<std::string> keepVolumes_;  // if not empty, only these volumes (and their mothers) are built
+    bool dropPrunedVolumes_;                // remove the other volumes instead of leaving empty placeholders
 
 
     // A message logger for this action
     mf::LogInfo logInfo_;
 
-    std::vector< std::pair<std::string,std::string>>  DetectorList;
+    // A sensitive detector resolved at geometry build time, with the instance
+    // name of its data product(s)
+    struct SDHandler_t {
+      SensitiveDetectorRegistry::Factory_t const* factory;
+      G4VSensitiveDetector*                       sd;
+      std::string                                 instance;
+    };
+
+    std::vector<SDHandler_t>                          sdHandlers_;             // one entry per sensitive volume, filled in doBuildLVs
     std::map<std::string, G4double>                   overrideGDMLStepLimit_Map;
     std::unordered_map<std::string, float>            setGDMLVolumes_;         // holds all <volume, steplimit> pairs set from the GDML file
+    std::unordered_map<G4LogicalVolume const*, G4double> importanceMap_;       // holds all <volume, importance> pairs set from the GDML file
+    std::map<std::string, std::vector<SpeciesStepLimits::Entry_t>> speciesStepLimits_; // per volume, step limits by species and energy
+    std::vector<std::string>                          fastSimParticles_;       // particles handled by fast simulation models
+    std::unique_ptr<OverlapChecker>                   overlapChecker_;         // set if the OverlapCheck table is configured
+    std::unique_ptr<PlacementCollapser>               placementCollapser_;     // set if the CollapsePlacements table is configured
+    std::string                                       geometryModifiers_;      // pruning and collapsing settings, part of the overlap cache key
+    G4VPhysicalVolume*                                worldPV_;                // world volume read from the GDML file
+    std::unique_ptr<NavigationBenchmark>              navigationBenchmark_;    // set if the NavigationBenchmark table is configured
+    std::unique_ptr<GeometryReport>                   geometryReport_;         // set if the GeometryReport table is configured
+
+    // Voxelization of a logical volume, overriding the GDML "Smartless" and
+    // "Optimise" auxiliary tags
+    struct VoxelSettings_t {
+      std::optional<G4double> smartless;
+      std::optional<bool>     optimise;
+    };
+    std::map<std::string, VoxelSettings_t>            voxelSettings_;          // per volume, from the configuration file
   public:
     LArG4DetectorService(fhicl::ParameterSet const&);
     ~LArG4DetectorService();
 
+    // Importance of a logical volume for geometry biasing, set with the
+    // "Importance" auxiliary tag in the GDML file (1 if not set)
+    G4double GetImportance(G4LogicalVolume const* lv) const;
+    bool     HasImportances() const { return !importanceMap_.empty(); }
+
+    // Names of the particles for which fast simulation models (e.g. Woodcock
+    // tracking) were defined; the fast simulation process must be activated
+    // for them once the physics list exists
+    std::vector<std::string> const& GetFastSimulationParticles() const { return fastSimParticles_; }
+
   private:
 
     // Private overriden methods
@@ -86,6 +141,27 @@ namespace larg4 {
     // -- D.R. Set the step limits for specific volumes from the configuration file
     void setStepLimits();
 
+    // Region having the volume as root, created if needed
+    G4Region* regionForVolume(G4LogicalVolume* lv, std::string const& regionName);
+
+    // Select the EM physics of the regions listed in the configuration file
+    void setRegionEmPhysics();
+
+    // Replace the step limits of the volumes listed in speciesStepLimits by
+    // limits depending on the particle species and kinetic energy
+    void setSpeciesStepLimits();
+
+    // Replace the subtrees not leading to any of keepVolumes_ with empty
+    // placeholders (same solid and material), or remove them; returns the
+    // logical volumes left in the tree
+    std::set<G4LogicalVolume const*> pruneGeometry(G4LogicalVolume* world);
+
+    // Apply the voxelization settings of the configuration file
+    void setVoxelSettings();
+
+    // Check the geometry below the world for overlaps, see OverlapChecker.h
+    void checkOverlaps(G4VPhysicalVolume const* world, std::string const& gdmlFile);
+
     // We need to add something to the art event, so we need these two methods:
 
     // Tell Art what we'll produce
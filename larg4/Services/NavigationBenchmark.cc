@@ -0,0 +1,145 @@
+//=============================================================================
+// NavigationBenchmark.cc: geantino navigation benchmark, see
+// NavigationBenchmark.h
+//=============================================================================
+#include "larg4/Services/NavigationBenchmark.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+// Geant 4 includes:
+#include "Geant4/G4GeometryManager.hh"
+#include "Geant4/G4GeometryTolerance.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Navigator.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VSolid.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/RandFlat.h"
+
+// C++ includes
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+  using clock_type = std::chrono::steady_clock;
+
+  double seconds(clock_type::time_point start, clock_type::time_point stop) {
+    return std::chrono::duration<double>(stop - start).count();
+  }
+}
+
+larg4::NavigationBenchmark::NavigationBenchmark(fhicl::ParameterSet const& p)
+  : fNRays(p.get<unsigned long>("nRays", 10000)),
+    fSeed(p.get<long>("seed", 12345)),
+    fMaxSteps(p.get<unsigned long>("maxSteps", 100000)),
+    fOutputFile(p.get<std::string>("outputFile", ""))
+{}
+
+std::vector<larg4::NavigationBenchmark::Result_t>
+larg4::NavigationBenchmark::run(G4VPhysicalVolume* world) const {
+  // -- voxelize the geometry as for the simulation
+  G4GeometryManager* geometryManager = G4GeometryManager::GetInstance();
+  bool const wasClosed = geometryManager->IsGeometryClosed();
+  if (!wasClosed) geometryManager->CloseGeometry(true);
+
+  G4Navigator navigator;
+  navigator.SetWorldVolume(world);
+
+  CLHEP::MixMaxRng engine(fSeed);
+  CLHEP::RandFlat flat(engine);
+  G4ThreeVector pMin, pMax;
+  world->GetLogicalVolume()->GetSolid()->BoundingLimits(pMin, pMax);
+  G4double const pushDistance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+
+  std::unordered_map<G4LogicalVolume const*, Result_t> byVolume;
+  auto resultFor = [&byVolume](G4VPhysicalVolume const* pv) -> Result_t& {
+    G4LogicalVolume const* lv = pv->GetLogicalVolume();
+    auto search = byVolume.find(lv);
+    if (search == byVolume.end()) search = byVolume.emplace(lv, Result_t{lv, 0, 0., 0, 0.}).first;
+    return search->second;
+  };
+
+  for (unsigned long ray = 0; ray < fNRays; ++ray) {
+    G4ThreeVector point(flat.fire(pMin.x(), pMax.x()), flat.fire(pMin.y(), pMax.y()), flat.fire(pMin.z(), pMax.z()));
+    G4double const cosTheta = flat.fire(-1., 1.);
+    G4double const phi = flat.fire(0., CLHEP::twopi);
+    G4double const sinTheta = std::sqrt(1. - cosTheta * cosTheta);
+    G4ThreeVector const direction(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+
+    auto start = clock_type::now();
+    G4VPhysicalVolume* pv = navigator.LocateGlobalPointAndSetup(point, &direction, false, false);
+    auto stop = clock_type::now();
+    if (!pv) continue; // outside the world solid, but inside its bounding box
+
+    Result_t* current = &resultFor(pv);
+    current->nLocates++;
+    current->locateTime += seconds(start, stop);
+    for (unsigned long step = 0; step < fMaxSteps; ++step) {
+      G4double safety = 0.;
+      start = clock_type::now();
+      G4double length = navigator.ComputeStep(point, direction, kInfinity, safety);
+      stop = clock_type::now();
+      current->nSteps++;
+      current->stepTime += seconds(start, stop);
+
+      // -- a ray stuck on a boundary is pushed forward
+      point += std::max(length, pushDistance) * direction;
+      navigator.SetGeometricallyLimitedStep();
+      start = clock_type::now();
+      pv = navigator.LocateGlobalPointAndSetup(point, &direction, true);
+      stop = clock_type::now();
+      if (!pv) break; // left the world
+
+      current = &resultFor(pv);
+      current->nLocates++;
+      current->locateTime += seconds(start, stop);
+    }
+  }
+
+  if (!wasClosed) geometryManager->OpenGeometry();
+
+  std::vector<Result_t> results;
+  for (auto const& entry : byVolume) results.push_back(entry.second);
+  std::sort(results.begin(), results.end(), [](Result_t const& a, Result_t const& b) {
+    return a.locateTime + a.stepTime > b.locateTime + b.stepTime;
+  });
+  return results;
+}
+
+void larg4::NavigationBenchmark::report(std::vector<Result_t> const& results) const {
+  std::ostringstream ss;
+  ss << "Navigation benchmark with " << fNRays << " geantinos (times per call in ns):\n"
+     << std::left << std::setw(32) << "volume" << std::right
+     << std::setw(10) << "daughters" << std::setw(10) << "smartless" << std::setw(9) << "optimise"
+     << std::setw(12) << "locates" << std::setw(10) << "locate" << std::setw(12) << "steps"
+     << std::setw(10) << "step" << "\n";
+  for (auto const& result : results) {
+    G4LogicalVolume const* lv = result.volume;
+    ss << std::left << std::setw(32) << lv->GetName() << std::right
+       << std::setw(10) << lv->GetNoDaughters() << std::setw(10) << lv->GetSmartless()
+       << std::setw(9) << (lv->IsToOptimise() ? "yes" : "no")
+       << std::setw(12) << result.nLocates
+       << std::setw(10) << std::fixed << std::setprecision(1)
+       << (result.nLocates ? 1.e9 * result.locateTime / result.nLocates : 0.)
+       << std::setw(12) << result.nSteps
+       << std::setw(10) << (result.nSteps ? 1.e9 * result.stepTime / result.nSteps : 0.) << "\n";
+  }
+  mf::LogInfo("NavigationBenchmark") << ss.str();
+
+  if (fOutputFile.empty()) return;
+  std::ofstream out(fOutputFile);
+  if (!out) {
+    MF_LOG_WARNING("NavigationBenchmark") << "Cannot write the navigation benchmark file " << fOutputFile;
+    return;
+  }
+  out << "volume,daughters,smartless,optimise,locates,locateTime,steps,stepTime\n";
+  for (auto const& result : results) {
+    G4LogicalVolume const* lv = result.volume;
+    out << lv->GetName() << "," << lv->GetNoDaughters() << "," << lv->GetSmartless() << ","
+        << lv->IsToOptimise() << "," << result.nLocates << "," << result.locateTime << ","
+        << result.nSteps << "," << result.stepTime << "\n";
+  }
+}
@@ -0,0 +1,61 @@
+//=============================================================================
+// NavigationBenchmark.h: shoots geantinos through the geometry and measures
+// the time spent locating points and computing steps in each logical volume,
+// to tune the voxelization (Smartless, Optimise) of the mother volumes.
+//
+// Rays start at random points of the world bounding box with isotropic
+// directions, and are followed with a dedicated G4Navigator until they leave
+// the world. A private random engine is used, so the benchmark does not change
+// the simulated events. The geometry is closed (voxelized) for the benchmark
+// and opened again afterwards. It is configured in LArG4DetectorService with
+//
+//   NavigationBenchmark: {
+//     nRays:      10000
+//     seed:       12345
+//     maxSteps:   100000   // per ray, protection against stuck rays
+//     outputFile: ""       // optional CSV file with the per volume results
+//   }
+//=============================================================================
+#ifndef NavigationBenchmark_h
+#define NavigationBenchmark_h 1
+
+#include "fhiclcpp/ParameterSet.h"
+#include "Geant4/globals.hh"
+
+#include <string>
+#include <vector>
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  class NavigationBenchmark {
+  public:
+    struct Result_t {
+      G4LogicalVolume const* volume;
+      unsigned long          nLocates;
+      double                 locateTime; ///< [s], total
+      unsigned long          nSteps;
+      double                 stepTime;   ///< [s], total
+    };
+
+    explicit NavigationBenchmark(fhicl::ParameterSet const& p);
+
+    // Run the benchmark in the geometry below the world volume; the results
+    // are sorted by decreasing total time
+    std::vector<Result_t> run(G4VPhysicalVolume* world) const;
+
+    // Log the results and write them to the output file, if any
+    void report(std::vector<Result_t> const& results) const;
+
+  private:
+    unsigned long fNRays;
+    long          fSeed;
+    unsigned long fMaxSteps;
+    std::string   fOutputFile;
+  };
+
+}   // namespace larg4
+
+#endif
@@ -0,0 +1,186 @@
+//=============================================================================
+// OverburdenMuonModel.cc: single step propagation of muons through the
+// overburden, see OverburdenMuonModel.h
+//=============================================================================
+#include "larg4/Services/OverburdenMuonModel.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+// Geant 4 includes:
+#include "Geant4/G4FastStep.hh"
+#include "Geant4/G4FastTrack.hh"
+#include "Geant4/G4GeometryTolerance.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4MuonMinus.hh"
+#include "Geant4/G4MuonPlus.hh"
+#include "Geant4/G4PhysicalConstants.hh"
+#include "Geant4/G4Poisson.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/G4TransportationManager.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VSolid.hh"
+#include "Geant4/Randomize.hh"
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+  // Largest fraction of the kinetic energy lost in one integration step
+  constexpr G4double kMaxLossFraction = 0.05;
+  // Fraction of the kinetic energy above which radiative losses are sampled
+  // one by one, instead of being added to the continuous loss
+  constexpr G4double kRadiativeCut = 0.01;
+  // Muon radiative processes known to G4EmCalculator
+  std::vector<G4String> const kRadiativeProcesses{"muBrems", "muPairProd"};
+}
+
+larg4::OverburdenMuonModel::OverburdenMuonModel(G4String const& name,
+                                                G4Region* envelope,
+                                                G4LogicalVolume const* envelopeLV,
+                                                G4double minKineticEnergy)
+  : G4VFastSimulationModel(name, envelope),
+    fEnvelopeLV(envelopeLV),
+    fMinKineticEnergy(minKineticEnergy)
+{
+  mf::LogInfo("OverburdenMuonModel") << "Fast muon propagation in volume " << envelopeLV->GetName()
+                                     << " (" << envelopeLV->GetMaterial()->GetName() << ") above "
+                                     << fMinKineticEnergy / CLHEP::GeV << " GeV";
+}
+
+larg4::OverburdenMuonModel::~OverburdenMuonModel() {
+}
+
+G4bool larg4::OverburdenMuonModel::IsApplicable(G4ParticleDefinition const& particle) {
+  return &particle == G4MuonMinus::MuonMinusDefinition() || &particle == G4MuonPlus::MuonPlusDefinition();
+}
+
+G4bool larg4::OverburdenMuonModel::ModelTrigger(G4FastTrack const& fastTrack) {
+  G4Track const* track = fastTrack.GetPrimaryTrack();
+  if (track->GetKineticEnergy() <= fMinKineticEnergy) return false;
+  // -- daughters of the overburden volume (e.g. the hall) get the full simulation
+  if (track->GetVolume()->GetLogicalVolume() != fEnvelopeLV) return false;
+  G4double const distanceOut = fastTrack.GetEnvelopeSolid()->DistanceToOut(fastTrack.GetPrimaryTrackLocalPosition(),
+                                                                             fastTrack.GetPrimaryTrackLocalDirection());
+  return distanceOut > G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+}
+
+G4double larg4::OverburdenMuonModel::bohrVariance(G4ParticleDefinition const* particle,
+                                                  G4Material const* material,
+                                                  G4double kineticEnergy, G4double length) const {
+  G4double const mass = particle->GetPDGMass();
+  G4double const gamma = 1. + kineticEnergy / mass;
+  G4double const beta2 = 1. - 1. / (gamma * gamma);
+  G4double const ratio = CLHEP::electron_mass_c2 / mass;
+  G4double const tmax = 2. * CLHEP::electron_mass_c2 * beta2 * gamma * gamma
+                        / (1. + 2. * gamma * ratio + ratio * ratio);
+  return tmax * (1. / beta2 - 0.5) * CLHEP::twopi_mc2_rcl2 * material->GetElectronDensity() * length;
+}
+
+void larg4::OverburdenMuonModel::DoIt(G4FastTrack const& fastTrack, G4FastStep& fastStep) {
+  if (!fNavigator) {
+    fNavigator = std::make_unique<G4Navigator>();
+    fNavigator->SetWorldVolume(G4TransportationManager::GetTransportationManager()
+                               ->GetNavigatorForTracking()->GetWorldVolume());
+  }
+
+  G4Track const* track = fastTrack.GetPrimaryTrack();
+  G4ParticleDefinition const* particle = track->GetDefinition();
+  G4Material const* material = fEnvelopeLV->GetMaterial();
+  G4double const mass = particle->GetPDGMass();
+  G4double const radiationLength = material->GetRadlen();
+  G4ThreeVector const& position = track->GetPosition();
+  G4ThreeVector const& direction = track->GetMomentumDirection();
+
+  // -- distance to the next boundary, daughter volumes included
+  G4double safety = 0.;
+  fNavigator->LocateGlobalPointAndSetup(position, &direction, false, false);
+  G4double const distance = fNavigator->ComputeStep(position, direction, kInfinity, safety);
+
+  // -- integrate the energy loss, the Bohr variance and the scattering along the path
+  G4double const startEnergy = track->GetKineticEnergy();
+  G4double energy = startEnergy;
+  G4double length = 0.;
+  G4double theta2 = 0.;
+  G4double timeOfFlight = 0.;
+  while (length < distance && energy > fMinKineticEnergy) {
+    // -- ionisation, and radiative losses below the cut, are continuous
+    G4double const cut = kRadiativeCut * energy;
+    G4double dedx = fCalculator.ComputeDEDX(energy, particle, "muIoni", material);
+    G4double radiativeXS = 0.;
+    for (auto const& process : kRadiativeProcesses) {
+      dedx += fCalculator.ComputeDEDX(energy, particle, process, material, cut);
+      radiativeXS += fCalculator.ComputeCrossSectionPerVolume(energy, particle, process, material, cut);
+    }
+    G4double step = distance - length;
+    if (dedx > 0.) step = std::min(step, kMaxLossFraction * energy / dedx);
+
+    G4double const momentum = std::sqrt(energy * (energy + 2. * mass));
+    G4double const beta = momentum / (energy + mass);
+    G4double const highland = 13.6 * CLHEP::MeV / (beta * momentum);
+    theta2 += highland * highland * step / radiationLength;
+    timeOfFlight += step / (beta * CLHEP::c_light);
+
+    // -- Gaussian fluctuation of the continuous loss
+    G4double loss = dedx * step;
+    G4double const variance = bohrVariance(particle, material, energy, step);
+    if (variance > 0.) loss = std::max(0., G4RandGauss::shoot(loss, std::sqrt(variance)));
+    // -- catastrophic radiative losses above the cut
+    for (G4long n = G4Poisson(radiativeXS * step); n > 0; --n) {
+      loss += sampleRadiativeFraction() * std::max(0., energy - loss);
+    }
+
+    energy -= loss;
+    length += step;
+  }
+  G4double const finalEnergy = std::max(0., energy);
+  G4double const loss = startEnergy - finalEnergy;
+
+  // -- multiple scattering (Highland formula with the log correction for the whole path):
+  // -- correlated deflection and lateral displacement in two orthogonal planes
+  G4double const correction = std::max(0., 1. + 0.038 * std::log(length / radiationLength));
+  G4double const theta0 = std::sqrt(theta2) * correction;
+  G4double const z1X = G4RandGauss::shoot(), z2X = G4RandGauss::shoot();
+  G4double const z1Y = G4RandGauss::shoot(), z2Y = G4RandGauss::shoot();
+  G4double const thetaX = z2X * theta0;
+  G4double const thetaY = z2Y * theta0;
+  G4double const shiftX = length * theta0 * (z1X / std::sqrt(12.) + z2X / 2.);
+  G4double const shiftY = length * theta0 * (z1Y / std::sqrt(12.) + z2Y / 2.);
+  G4ThreeVector const u = direction.orthogonal().unit();
+  G4ThreeVector const v = direction.cross(u);
+
+  // -- the displaced end point must stay in the overburden volume itself; at the
+  // -- boundary, it is moved back onto the boundary along the original direction
+  G4ThreeVector finalPosition = position + length * direction;
+  G4ThreeVector const displaced = finalPosition + shiftX * u + shiftY * v;
+  G4VPhysicalVolume const* volume = fNavigator->LocateGlobalPointAndSetup(displaced, &direction, false, false);
+  if (volume && volume->GetLogicalVolume() == fEnvelopeLV) {
+    finalPosition = displaced;
+    if (length >= distance) {
+      finalPosition += fNavigator->ComputeStep(displaced, direction, kInfinity, safety) * direction;
+    }
+  }
+
+  fastStep.ProposePrimaryTrackFinalPosition(finalPosition, false);
+  fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + timeOfFlight);
+  fastStep.ProposePrimaryTrackPathLength(length);
+  if (finalEnergy <= 0.) {
+    fastStep.KillPrimaryTrack();
+    fastStep.ProposeTotalEnergyDeposited(startEnergy);
+    return;
+  }
+  fastStep.ProposePrimaryTrackFinalKineticEnergy(finalEnergy);
+  fastStep.ProposeTotalEnergyDeposited(loss);
+
+  G4double const theta = std::min(std::sqrt(thetaX * thetaX + thetaY * thetaY), CLHEP::pi);
+  G4double const phi = std::atan2(thetaY, thetaX);
+  G4ThreeVector const newDirection = std::cos(theta) * direction
+                                   + std::sin(theta) * (std::cos(phi) * u + std::sin(phi) * v);
+  fastStep.ProposePrimaryTrackFinalMomentumDirection(newDirection.unit(), false);
+}
+
+G4double larg4::OverburdenMuonModel::sampleRadiativeFraction() const {
+  // -- dsigma/dv ~ 1/v between the cut and the full energy
+  return std::pow(kRadiativeCut, 1. - G4UniformRand());
+}
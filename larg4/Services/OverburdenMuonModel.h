@@ -0,0 +1,75 @@
+//=============================================================================
+// OverburdenMuonModel.h: fast simulation model propagating muons through a
+// thick overburden volume (rock, concrete) in a single step.
+//
+// The muon is moved in a straight line to the next boundary of the volume,
+// integrating the energy loss along the path (no secondaries are produced, the
+// energy is deposited in the overburden):
+// - ionisation, and radiative losses (muBrems, muPairProd) below 1% of the
+//   kinetic energy, are continuous, with a Gaussian fluctuation of Bohr
+//   variance;
+// - radiative losses above 1% of the kinetic energy are sampled one by one,
+//   with the Geant4 cross-sections for their number. Their size is sampled
+//   from a 1/v spectrum (v: fraction of the energy lost), which describes
+//   bremsstrahlung well but overestimates the hardest pair production losses;
+//   photonuclear losses are not included.
+// The direction is deflected and the end point laterally displaced according
+// to the Highland formula for multiple scattering (correlated sampling); the
+// displacement is dropped if it would move the muon out of the overburden
+// volume or into one of its daughters. Muons falling below the minimum kinetic
+// energy are handed back to the full Geant4 transport where they are, so that
+// they stop and decay or are captured with the standard physics; the same
+// happens at the boundary of the volume, e.g. when entering the detector hall.
+//
+// The model is attached by LArG4DetectorService to the logical volumes with
+//
+//   <auxiliary auxtype="Overburden" auxvalue="1" auxunit="GeV"/>
+//
+// in the GDML file, where the value is the minimum kinetic energy for the fast
+// propagation (in GeV if given without unit). The fast simulation region only
+// covers the overburden volume itself: its daughter volumes (e.g. the hall)
+// are always simulated with the full Geant4 transport.
+//=============================================================================
+#ifndef OverburdenMuonModel_h
+#define OverburdenMuonModel_h 1
+
+#include "Geant4/G4VFastSimulationModel.hh"
+#include "Geant4/G4EmCalculator.hh"
+#include "Geant4/G4Navigator.hh"
+
+#include <memory>
+
+class G4LogicalVolume;
+class G4Material;
+class G4ParticleDefinition;
+class G4Region;
+
+namespace larg4 {
+
+  class OverburdenMuonModel : public G4VFastSimulationModel {
+  public:
+    OverburdenMuonModel(G4String const& name, G4Region* envelope, G4LogicalVolume const* envelopeLV,
+                        G4double minKineticEnergy);
+    virtual ~OverburdenMuonModel();
+
+    G4bool IsApplicable(G4ParticleDefinition const& particle) override;
+    G4bool ModelTrigger(G4FastTrack const& fastTrack) override;
+    void   DoIt(G4FastTrack const& fastTrack, G4FastStep& fastStep) override;
+
+  private:
+    // Variance of the energy loss over the length, Bohr approximation
+    G4double bohrVariance(G4ParticleDefinition const* particle, G4Material const* material,
+                          G4double kineticEnergy, G4double length) const;
+
+    // Fraction of the kinetic energy lost in one radiative loss above the cut
+    G4double sampleRadiativeFraction() const;
+
+    G4LogicalVolume const*       fEnvelopeLV;       ///< overburden volume
+    G4double                     fMinKineticEnergy; ///< below this, full Geant4 transport
+    G4EmCalculator               fCalculator;
+    std::unique_ptr<G4Navigator> fNavigator;        ///< private navigator for the distance to the boundary
+  };
+
+}   // namespace larg4
+
+#endif
@@ -0,0 +1,327 @@
+//=============================================================================
+// OverlapChecker.cc: multi-threaded and cached overlap check, see
+// OverlapChecker.h
+//=============================================================================
+#include "larg4/Services/OverlapChecker.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+// Geant 4 includes:
+#include "Geant4/G4AffineTransform.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VSolid.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/Randomize.hh"
+
+// C++ includes
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+  // Threads started once, each running the given work for every batch
+  // together with the calling thread
+  class WorkerPool {
+  public:
+    WorkerPool(unsigned nWorkers, std::function<void()> work) : fWork(std::move(work)) {
+      for (unsigned i = 0; i < nWorkers; ++i) fThreads.emplace_back([this]() { loop(); });
+    }
+
+    ~WorkerPool() {
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStop = true;
+      }
+      fStart.notify_all();
+      for (auto& thread : fThreads) thread.join();
+    }
+
+    // Run the work on all the threads, and wait for all of them to finish
+    void run() {
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fBusy = fThreads.size();
+        ++fGeneration;
+      }
+      fStart.notify_all();
+      fWork();
+      std::unique_lock<std::mutex> lock(fMutex);
+      fDone.wait(lock, [this]() { return fBusy == 0; });
+    }
+
+  private:
+    void loop() {
+      unsigned long seen = 0;
+      while (true) {
+        {
+          std::unique_lock<std::mutex> lock(fMutex);
+          fStart.wait(lock, [this, seen]() { return fStop || fGeneration != seen; });
+          if (fStop) return;
+          seen = fGeneration;
+        }
+        fWork();
+        {
+          std::lock_guard<std::mutex> lock(fMutex);
+          --fBusy;
+        }
+        fDone.notify_one();
+      }
+    }
+
+    std::function<void()>    fWork;
+    std::vector<std::thread> fThreads;
+    std::mutex               fMutex;
+    std::condition_variable  fStart, fDone;
+    unsigned long            fGeneration = 0;
+    size_t                   fBusy = 0;
+    bool                     fStop = false;
+  };
+
+  // Axis-aligned box in the frame of the mother volume
+  struct Extent_t {
+    G4ThreeVector min, max;
+    bool contains(G4ThreeVector const& p, G4double tolerance) const {
+      return p.x() > min.x() - tolerance && p.x() < max.x() + tolerance
+          && p.y() > min.y() - tolerance && p.y() < max.y() + tolerance
+          && p.z() > min.z() - tolerance && p.z() < max.z() + tolerance;
+    }
+  };
+
+  // A daughter placement, with everything needed to test points against it
+  struct Placement_t {
+    G4VPhysicalVolume const* pv;
+    G4VSolid const*          solid;
+    G4AffineTransform        toMother;   ///< daughter frame to mother frame
+    G4AffineTransform        fromMother; ///< mother frame to daughter frame
+    Extent_t                 extent;     ///< bounding box in the mother frame
+    G4ThreeVector            surfacePoint; ///< one point on the surface, daughter frame
+  };
+
+  // The daughters of one mother volume, all of which are checked
+  struct Mother_t {
+    G4LogicalVolume const*   lv;
+    std::vector<Placement_t> daughters;
+  };
+
+  Placement_t makePlacement(G4VPhysicalVolume const* pv) {
+    Placement_t placement{pv, pv->GetLogicalVolume()->GetSolid(),
+                          G4AffineTransform(pv->GetRotation(), pv->GetTranslation()), {}, {}, {}};
+    placement.fromMother = placement.toMother.Inverse();
+    G4ThreeVector pMin, pMax;
+    placement.solid->BoundingLimits(pMin, pMax);
+    placement.extent = {G4ThreeVector(DBL_MAX, DBL_MAX, DBL_MAX), G4ThreeVector(-DBL_MAX, -DBL_MAX, -DBL_MAX)};
+    for (int corner = 0; corner < 8; ++corner) {
+      G4ThreeVector const p = placement.toMother.TransformPoint(
+        G4ThreeVector((corner & 1) ? pMax.x() : pMin.x(),
+                      (corner & 2) ? pMax.y() : pMin.y(),
+                      (corner & 4) ? pMax.z() : pMin.z()));
+      placement.extent.min.set(std::min(placement.extent.min.x(), p.x()),
+                               std::min(placement.extent.min.y(), p.y()),
+                               std::min(placement.extent.min.z(), p.z()));
+      placement.extent.max.set(std::max(placement.extent.max.x(), p.x()),
+                               std::max(placement.extent.max.y(), p.y()),
+                               std::max(placement.extent.max.z(), p.z()));
+    }
+    placement.surfacePoint = placement.solid->GetPointOnSurface();
+    return placement;
+  }
+
+  void collectMothers(G4LogicalVolume const* lv, std::set<G4LogicalVolume const*>& visited,
+                      std::vector<Mother_t>& mothers) {
+    if (!visited.insert(lv).second) return;
+    Mother_t mother{lv, {}};
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+      G4VPhysicalVolume const* daughter = lv->GetDaughter(i);
+      if (!daughter->IsReplicated()) mother.daughters.push_back(makePlacement(daughter));
+      collectMothers(daughter->GetLogicalVolume(), visited, mothers);
+    }
+    if (!mother.daughters.empty()) mothers.push_back(std::move(mother));
+  }
+
+  std::string describe(G4VPhysicalVolume const* pv) {
+    std::ostringstream ss;
+    ss << pv->GetName() << " (copy " << pv->GetCopyNo() << ")";
+    return ss.str();
+  }
+
+  // Test the surface points of one daughter against its mother and siblings
+  larg4::OverlapChecker::Result_t checkPlacement(Mother_t const& mother, size_t index,
+                                                 std::vector<G4ThreeVector> const& points,
+                                                 G4double tolerance) {
+    Placement_t const& placement = mother.daughters[index];
+    G4VSolid const* motherSolid = mother.lv->GetSolid();
+
+    G4double motherOverlap = 0.;
+    std::map<size_t, G4double> siblingOverlaps;
+    for (auto const& point : points) {
+      G4ThreeVector const mp = placement.toMother.TransformPoint(point);
+      if (motherSolid->Inside(mp) == kOutside) {
+        G4double const distance = motherSolid->DistanceToIn(mp);
+        if (distance > tolerance) motherOverlap = std::max(motherOverlap, distance);
+      }
+      for (size_t j = 0; j < mother.daughters.size(); ++j) {
+        if (j == index) continue;
+        Placement_t const& sibling = mother.daughters[j];
+        if (!sibling.extent.contains(mp, tolerance)) continue;
+        G4ThreeVector const sp = sibling.fromMother.TransformPoint(mp);
+        if (sibling.solid->Inside(sp) != kInside) continue;
+        G4double const distance = sibling.solid->DistanceToOut(sp);
+        if (distance > tolerance) {
+          G4double& overlap = siblingOverlaps[j];
+          overlap = std::max(overlap, distance);
+        }
+      }
+    }
+
+    std::ostringstream ss;
+    if (motherOverlap > 0.) {
+      ss << " protrudes from mother " << mother.lv->GetName() << " by up to "
+         << motherOverlap / CLHEP::mm << " mm;";
+    }
+    for (auto const& [j, overlap] : siblingOverlaps) {
+      ss << " overlaps with " << describe(mother.daughters[j].pv) << " by up to "
+         << overlap / CLHEP::mm << " mm;";
+    }
+    // -- a sibling completely inside this volume would not be found by the tests above
+    for (size_t j = 0; j < mother.daughters.size(); ++j) {
+      if (j == index || siblingOverlaps.count(j)) continue;
+      Placement_t const& sibling = mother.daughters[j];
+      G4ThreeVector const mp = sibling.toMother.TransformPoint(sibling.surfacePoint);
+      if (!placement.extent.contains(mp, tolerance)) continue;
+      if (placement.solid->Inside(placement.fromMother.TransformPoint(mp)) == kInside) {
+        ss << " may fully contain " << describe(sibling.pv) << ";";
+      }
+    }
+
+    std::string const description = ss.str();
+    return {placement.pv->GetName(), placement.pv->GetCopyNo(), !description.empty(), description};
+  }
+
+}
+
+larg4::OverlapChecker::OverlapChecker(fhicl::ParameterSet const& p)
+  : fNThreads(p.get<unsigned>("nThreads", 0)),
+    fNPoints(p.get<G4int>("nPoints", 10000)),
+    fTolerance(p.get<G4double>("tolerance", 0.) * CLHEP::mm),
+    fCacheFile(p.get<std::string>("cacheFile", "")),
+    fAbortOnOverlap(p.get<bool>("abortOnOverlap", false))
+{
+  if (fNThreads == 0) fNThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<larg4::OverlapChecker::Result_t>
+larg4::OverlapChecker::check(G4VPhysicalVolume const* world, std::uint64_t geometryHash) {
+  std::vector<Result_t> results;
+  if (readCache(geometryHash, results)) {
+    mf::LogInfo("OverlapChecker") << "Overlap check results for this geometry read from " << fCacheFile;
+    return results;
+  }
+
+  // -- the surface points are sampled with the Geant4 engine: leave it as it was
+  std::ostringstream engineState;
+  G4Random::getTheEngine()->put(engineState);
+
+  std::vector<Mother_t> mothers;
+  std::set<G4LogicalVolume const*> visited;
+  collectMothers(world->GetLogicalVolume(), visited, mothers);
+
+  // -- sample the points sequentially for a batch of placements, then test them in parallel
+  size_t const batchSize = 4 * fNThreads;
+  std::vector<std::pair<Mother_t const*, size_t>> batch;
+  std::vector<std::vector<G4ThreeVector>> points;
+  std::vector<Result_t> batchResults;
+  std::atomic<size_t> next{0};
+  // -- the workers are started once and take the placements of each batch in turn
+  WorkerPool pool(fNThreads - 1, [&]() {
+    for (size_t i = next++; i < batch.size(); i = next++) {
+      batchResults[i] = checkPlacement(*batch[i].first, batch[i].second, points[i], fTolerance);
+    }
+  });
+  auto processBatch = [&]() {
+    batchResults.assign(batch.size(), Result_t{});
+    next = 0;
+    pool.run();
+    results.insert(results.end(), batchResults.begin(), batchResults.end());
+    batch.clear();
+    points.clear();
+  };
+  for (auto const& mother : mothers) {
+    for (size_t i = 0; i < mother.daughters.size(); ++i) {
+      std::vector<G4ThreeVector> surfacePoints(fNPoints);
+      for (auto& point : surfacePoints) point = mother.daughters[i].solid->GetPointOnSurface();
+      batch.emplace_back(&mother, i);
+      points.push_back(std::move(surfacePoints));
+      if (batch.size() == batchSize) processBatch();
+    }
+  }
+  processBatch();
+
+  std::istringstream restoreState(engineState.str());
+  G4Random::getTheEngine()->get(restoreState);
+
+  writeCache(geometryHash, results);
+  return results;
+}
+
+bool larg4::OverlapChecker::readCache(std::uint64_t key, std::vector<Result_t>& results) const {
+  if (fCacheFile.empty()) return false;
+  std::ifstream in(fCacheFile);
+  if (!in) return false;
+
+  std::string header;
+  std::getline(in, header);
+  std::ostringstream expected;
+  expected << "larg4-overlaps " << std::hex << key << std::dec << " " << fNPoints << " " << fTolerance / CLHEP::mm;
+  if (header != expected.str()) return false;
+
+  // -- a line that cannot be parsed (e.g. a truncated file) makes the whole cache a miss
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string status, copyNo, volume, description;
+    if (!std::getline(fields, status, '\t') || !std::getline(fields, copyNo, '\t')
+        || !std::getline(fields, volume, '\t')) {
+      results.clear();
+      return false;
+    }
+    std::getline(fields, description);
+    char* end = nullptr;
+    long const copy = std::strtol(copyNo.c_str(), &end, 10);
+    if (copyNo.empty() || *end != '\0' || (status != "PASS" && status != "FAIL")) {
+      results.clear();
+      return false;
+    }
+    results.push_back({volume, static_cast<G4int>(copy), status == "FAIL", description});
+  }
+  return true;
+}
+
+void larg4::OverlapChecker::writeCache(std::uint64_t key, std::vector<Result_t> const& results) const {
+  if (fCacheFile.empty()) return;
+  // -- written to a temporary file first, so that an interrupted job never leaves a partial cache
+  std::string const tmpFile = fCacheFile + ".tmp";
+  {
+    std::ofstream out(tmpFile);
+    if (out) {
+      out << "larg4-overlaps " << std::hex << key << std::dec << " " << fNPoints << " " << fTolerance / CLHEP::mm << "\n";
+      for (auto const& result : results) {
+        out << (result.overlaps ? "FAIL" : "PASS") << "\t" << result.copyNo << "\t"
+            << result.volume << "\t" << result.description << "\n";
+      }
+    }
+    out.close();
+    if (out && std::rename(tmpFile.c_str(), fCacheFile.c_str()) == 0) return;
+  }
+  std::remove(tmpFile.c_str());
+  MF_LOG_WARNING("OverlapChecker") << "Cannot write the overlap check cache file " << fCacheFile;
+}
@@ -0,0 +1,72 @@
+//=============================================================================
+// OverlapChecker.h: multi-threaded check of the geometry for overlapping
+// volumes, with results cached per geometry.
+//
+// For every G4PVPlacement in the geometry, points are sampled on the surface
+// of its solid and tested, as in G4PVPlacement::CheckOverlaps, against its
+// mother (the points must not be outside) and its sibling volumes (the points
+// must not be inside). The surface points are sampled sequentially and the
+// Inside() tests, which take most of the time, are spread over threads.
+//
+// If a cache file is given, the results are written to it together with a
+// hash of the GDML files, of the settings of LArG4DetectorService modifying
+// the tree read from them (keepVolumes, CollapsePlacements) and of the check
+// settings; when the cache matches, the check is not repeated. It is
+// configured in LArG4DetectorService with
+//
+//   OverlapCheck: {
+//     nThreads:       0        // 0 means one per hardware thread
+//     nPoints:        10000    // surface points per placement
+//     tolerance:      0.       // [mm] overlaps smaller than this are ignored
+//     cacheFile:      ""       // e.g. "/path/to/overlaps.cache", empty disables the cache
+//     abortOnOverlap: false    // throw if any overlap is found
+//   }
+//
+// Since the geometry is built when larg4Main is constructed, running a job
+// with zero events performs the check alone.
+//=============================================================================
+#ifndef OverlapChecker_h
+#define OverlapChecker_h 1
+
+#include "fhiclcpp/ParameterSet.h"
+#include "Geant4/globals.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  class OverlapChecker {
+  public:
+    struct Result_t {
+      std::string volume;      ///< physical volume name
+      G4int       copyNo;      ///< copy number of the placement
+      bool        overlaps;    ///< whether an overlap was found
+      std::string description; ///< what overlaps with what, and by how much
+    };
+
+    explicit OverlapChecker(fhicl::ParameterSet const& p);
+
+    // Check all the placements below the world volume; the hash identifies
+    // the geometry (see GDMLFiles.h)
+    std::vector<Result_t> check(G4VPhysicalVolume const* world, std::uint64_t geometryHash);
+
+    bool abortOnOverlap() const { return fAbortOnOverlap; }
+
+  private:
+    bool readCache(std::uint64_t key, std::vector<Result_t>& results) const;
+    void writeCache(std::uint64_t key, std::vector<Result_t> const& results) const;
+
+    unsigned    fNThreads;
+    G4int       fNPoints;
+    G4double    fTolerance;
+    std::string fCacheFile;
+    bool        fAbortOnOverlap;
+  };
+
+}   // namespace larg4
+
+#endif
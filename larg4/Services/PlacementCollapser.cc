@@ -0,0 +1,281 @@
+//=============================================================================
+// PlacementCollapser.cc: replaces arrays of identical placements by replicas
+// or parameterised volumes, see PlacementCollapser.h
+//=============================================================================
+#include "larg4/Services/PlacementCollapser.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+// Geant 4 includes:
+#include "Geant4/G4AffineTransform.hh"
+#include "Geant4/G4AutoDelete.hh"
+#include "Geant4/G4Box.hh"
+#include "Geant4/G4GeometryTolerance.hh"
+#include "Geant4/G4LogicalBorderSurface.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4PVParameterised.hh"
+#include "Geant4/G4PVPlacement.hh"
+#include "Geant4/G4PVReplica.hh"
+#include "Geant4/G4VPVParameterisation.hh"
+#include "Geant4/G4VisAttributes.hh"
+
+// C++ includes
+#include <algorithm>
+#include <memory>
+#include <set>
+
+namespace {
+
+  // Positions of the copies, indexed by copy number, with a common rotation
+  class TablePlacementParameterisation : public G4VPVParameterisation {
+  public:
+    TablePlacementParameterisation(std::vector<G4ThreeVector> translations, G4RotationMatrix const* rotation)
+      : fTranslations(std::move(translations)),
+        fRotation(rotation ? std::make_unique<G4RotationMatrix>(*rotation) : nullptr)
+    {}
+
+    void ComputeTransformation(G4int const copyNo, G4VPhysicalVolume* pv) const override {
+      pv->SetTranslation(fTranslations[copyNo]);
+      pv->SetRotation(fRotation.get());
+    }
+
+  private:
+    std::vector<G4ThreeVector>        fTranslations;
+    std::unique_ptr<G4RotationMatrix> fRotation;
+  };
+
+  struct Box_t {
+    G4ThreeVector min{DBL_MAX, DBL_MAX, DBL_MAX}, max{-DBL_MAX, -DBL_MAX, -DBL_MAX};
+    void add(G4ThreeVector const& p) {
+      min.set(std::min(min.x(), p.x()), std::min(min.y(), p.y()), std::min(min.z(), p.z()));
+      max.set(std::max(max.x(), p.x()), std::max(max.y(), p.y()), std::max(max.z(), p.z()));
+    }
+    void add(Box_t const& b) { add(b.min); add(b.max); }
+    bool intersects(Box_t const& b, G4double tolerance) const {
+      return min.x() < b.max.x() - tolerance && b.min.x() < max.x() - tolerance
+          && min.y() < b.max.y() - tolerance && b.min.y() < max.y() - tolerance
+          && min.z() < b.max.z() - tolerance && b.min.z() < max.z() - tolerance;
+    }
+  };
+
+  // Bounding box of a daughter in the frame of its mother
+  Box_t extentInMother(G4VPhysicalVolume const* pv) {
+    G4AffineTransform const toMother(pv->GetRotation(), pv->GetTranslation());
+    G4ThreeVector pMin, pMax;
+    pv->GetLogicalVolume()->GetSolid()->BoundingLimits(pMin, pMax);
+    Box_t box;
+    for (int corner = 0; corner < 8; ++corner) {
+      box.add(toMother.TransformPoint(G4ThreeVector((corner & 1) ? pMax.x() : pMin.x(),
+                                                    (corner & 2) ? pMax.y() : pMin.y(),
+                                                    (corner & 4) ? pMax.z() : pMin.z())));
+    }
+    return box;
+  }
+
+  bool sameRotation(G4RotationMatrix const* a, G4RotationMatrix const* b) {
+    G4RotationMatrix const identity;
+    G4RotationMatrix const& ra = a ? *a : identity;
+    G4RotationMatrix const& rb = b ? *b : identity;
+    return (ra.colX() - rb.colX()).mag2() < 1.e-18 && (ra.colY() - rb.colY()).mag2() < 1.e-18
+        && (ra.colZ() - rb.colZ()).mag2() < 1.e-18;
+  }
+
+  // The border surface of an entry of the G4LogicalBorderSurface table, which
+  // is a vector of surfaces or a map from the pairs of volumes to the surfaces
+  // depending on the Geant4 version
+  G4LogicalBorderSurface const* borderSurface(G4LogicalBorderSurface* surface) { return surface; }
+  template <typename Entry>
+  G4LogicalBorderSurface const* borderSurface(Entry const& entry) { return entry.second; }
+
+  // Physical volumes on either side of a border surface, which must not be
+  // deleted
+  std::set<G4VPhysicalVolume const*> volumesWithBorderSurfaces() {
+    std::set<G4VPhysicalVolume const*> volumes;
+    if (auto const* table = G4LogicalBorderSurface::GetSurfaceTable()) {
+      for (auto const& entry : *table) {
+        volumes.insert(borderSurface(entry)->GetVolume1());
+        volumes.insert(borderSurface(entry)->GetVolume2());
+      }
+    }
+    return volumes;
+  }
+
+  // Whether the volume or any of its descendants has a sensitive detector
+  bool hasSensitiveDetector(G4LogicalVolume const* lv) {
+    if (lv->GetSensitiveDetector()) return true;
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+      if (hasSensitiveDetector(lv->GetDaughter(i)->GetLogicalVolume())) return true;
+    }
+    return false;
+  }
+
+  void collectMothers(G4LogicalVolume* lv, std::set<G4LogicalVolume*>& visited,
+                      std::vector<G4LogicalVolume*>& mothers) {
+    if (!visited.insert(lv).second) return;
+    if (lv->GetNoDaughters() > 0) mothers.push_back(lv);
+    for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+      collectMothers(lv->GetDaughter(i)->GetLogicalVolume(), visited, mothers);
+    }
+  }
+
+  // Axis along which the group (sorted by copy number) evenly slices its box
+  // mother, kUndefined if it does not
+  EAxis replicaAxis(G4LogicalVolume const* mother, std::vector<G4VPhysicalVolume*> const& group,
+                    G4double tolerance) {
+    auto const* motherBox = dynamic_cast<G4Box const*>(mother->GetSolid());
+    auto const* box = dynamic_cast<G4Box const*>(group.front()->GetLogicalVolume()->GetSolid());
+    if (!motherBox || !box || !sameRotation(group.front()->GetRotation(), nullptr)) return kUndefined;
+    if (static_cast<size_t>(mother->GetNoDaughters()) != group.size()) return kUndefined;
+
+    G4ThreeVector const motherHalf(motherBox->GetXHalfLength(), motherBox->GetYHalfLength(), motherBox->GetZHalfLength());
+    G4ThreeVector const half(box->GetXHalfLength(), box->GetYHalfLength(), box->GetZHalfLength());
+    G4int const n = group.size();
+    for (EAxis axis : {kXAxis, kYAxis, kZAxis}) {
+      bool slices = std::abs(n * half[axis] - motherHalf[axis]) < tolerance;
+      for (int other = 0; other < 3 && slices; ++other) {
+        if (other != axis) slices = std::abs(half[other] - motherHalf[other]) < tolerance;
+      }
+      for (G4int i = 0; i < n && slices; ++i) {
+        G4ThreeVector expected;
+        expected[axis] = -motherHalf[axis] + (2 * i + 1) * half[axis];
+        slices = (group[i]->GetTranslation() - expected).mag() < tolerance;
+      }
+      if (slices) return axis;
+    }
+    return kUndefined;
+  }
+
+}
+
+larg4::PlacementCollapser::PlacementCollapser(fhicl::ParameterSet const& p)
+  : fMinCopies(p.get<G4int>("minCopies", 16)),
+    fUseReplicas(p.get<bool>("useReplicas", true))
+{
+  if (fMinCopies < 2) {
+    throw cet::exception("PlacementCollapser") << "Configuration error: minCopies must be at least 2,"
+                                               << " found " << fMinCopies << "\n";
+  }
+}
+
+std::vector<std::pair<G4LogicalVolume*, G4LogicalVolume*>>
+larg4::PlacementCollapser::collapse(G4VPhysicalVolume* world) {
+  G4double const tolerance = G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+  std::vector<std::pair<G4LogicalVolume*, G4LogicalVolume*>> envelopes;
+
+  std::vector<G4LogicalVolume*> mothers;
+  std::set<G4LogicalVolume*> visited;
+  collectMothers(world->GetLogicalVolume(), visited, mothers);
+  auto const bordered = volumesWithBorderSurfaces();
+
+  for (G4LogicalVolume* mother : mothers) {
+    // -- group the placements by logical volume and rotation, keeping the GDML order
+    std::vector<std::vector<G4VPhysicalVolume*>> groups;
+    for (G4int i = 0; i < mother->GetNoDaughters(); ++i) {
+      G4VPhysicalVolume* daughter = mother->GetDaughter(i);
+      if (daughter->IsReplicated()) continue;
+      auto group = std::find_if(groups.begin(), groups.end(), [daughter](auto const& g) {
+        return g.front()->GetLogicalVolume() == daughter->GetLogicalVolume()
+            && sameRotation(g.front()->GetRotation(), daughter->GetRotation());
+      });
+      if (group == groups.end()) groups.push_back({daughter});
+      else group->push_back(daughter);
+    }
+
+    for (auto& group : groups) {
+      G4int const n = group.size();
+      if (n < fMinCopies) continue;
+      G4VPhysicalVolume const* first = group.front();
+      std::string const name = first->GetName();
+      G4LogicalVolume* lv = first->GetLogicalVolume();
+
+      // -- the copy numbers must be 0..N-1 to be preserved
+      std::sort(group.begin(), group.end(), [](auto const* a, auto const* b) { return a->GetCopyNo() < b->GetCopyNo(); });
+      bool sequential = true;
+      for (G4int i = 0; i < n && sequential; ++i) sequential = (group[i]->GetCopyNo() == i);
+      if (!sequential) {
+        mf::LogInfo("PlacementCollapser") << "Not collapsing the " << n << " placements of " << lv->GetName()
+                                          << " in " << mother->GetName() << ": copy numbers are not 0.."
+                                          << n - 1;
+        continue;
+      }
+
+      // -- a border surface refers to the placement itself, which is deleted
+      if (std::any_of(group.begin(), group.end(), [&bordered](auto const* pv) { return bordered.count(pv) > 0; })) {
+        mf::LogInfo("PlacementCollapser") << "Not collapsing the " << n << " placements of " << lv->GetName()
+                                          << " in " << mother->GetName() << ": they have border surfaces";
+        continue;
+      }
+
+      EAxis const axis = fUseReplicas ? replicaAxis(mother, group, tolerance) : kUndefined;
+
+      // -- a parameterised volume alone in its mother, or in an envelope
+      G4LogicalVolume* container = mother;
+      G4ThreeVector offset;
+      if (axis == kUndefined && static_cast<size_t>(mother->GetNoDaughters()) != group.size()) {
+        Box_t extent;
+        for (auto const* pv : group) extent.add(extentInMother(pv));
+        bool fits = true;
+        for (G4int i = 0; i < mother->GetNoDaughters() && fits; ++i) {
+          G4VPhysicalVolume const* other = mother->GetDaughter(i);
+          if (std::find(group.begin(), group.end(), other) != group.end()) continue;
+          fits = !extent.intersects(extentInMother(other), tolerance);
+        }
+        for (int corner = 0; corner < 8 && fits; ++corner) {
+          G4ThreeVector const p((corner & 1) ? extent.max.x() : extent.min.x(),
+                                (corner & 2) ? extent.max.y() : extent.min.y(),
+                                (corner & 4) ? extent.max.z() : extent.min.z());
+          fits = mother->GetSolid()->Inside(p) != kOutside;
+        }
+        if (!fits) {
+          mf::LogInfo("PlacementCollapser") << "Not collapsing the " << n << " placements of " << lv->GetName()
+                                            << " in " << mother->GetName()
+                                            << ": no room for an envelope";
+          continue;
+        }
+        // -- an envelope adds a level to the touchable history, which changes the copy numbers
+        //    (e.g. of the AuxDet channels) read by the sensitive detectors at and below the mother
+        if ((mother->GetSensitiveDetector() || hasSensitiveDetector(lv))) {
+          mf::LogInfo("PlacementCollapser") << "Not collapsing the " << n << " placements of " << lv->GetName()
+                                            << " in " << mother->GetName()
+                                            << ": an envelope would change the copy numbers seen by"
+                                            << " the sensitive detectors";
+          continue;
+        }
+        offset = 0.5 * (extent.min + extent.max);
+        G4ThreeVector const half = 0.5 * (extent.max - extent.min);
+        std::string const envelopeName = name + "_Envelope";
+        container = new G4LogicalVolume(new G4Box(envelopeName, half.x(), half.y(), half.z()),
+                                        mother->GetMaterial(), envelopeName);
+        container->SetUserLimits(mother->GetUserLimits());
+        if (mother->GetFieldManager()) container->SetFieldManager(mother->GetFieldManager(), false);
+        container->SetVisAttributes(G4VisAttributes::GetInvisible());
+        new G4PVPlacement(nullptr, offset, container, envelopeName, mother, false, 0);
+        envelopes.emplace_back(container, mother);
+      }
+
+      // -- the positions (and rotation) are copied before the placements are deleted
+      G4VPVParameterisation* parameterisation = nullptr;
+      if (axis == kUndefined) {
+        std::vector<G4ThreeVector> translations;
+        for (auto const* pv : group) translations.push_back(pv->GetTranslation() - offset);
+        parameterisation = new TablePlacementParameterisation(std::move(translations), first->GetRotation());
+        G4AutoDelete::Register(parameterisation);
+      }
+      for (auto* pv : group) {
+        mother->RemoveDaughter(pv);
+        delete pv;
+      }
+      if (parameterisation) {
+        new G4PVParameterised(name, lv, container, kUndefined, n, parameterisation);
+      } else {
+        auto const* box = static_cast<G4Box const*>(lv->GetSolid());
+        G4ThreeVector const half(box->GetXHalfLength(), box->GetYHalfLength(), box->GetZHalfLength());
+        new G4PVReplica(name, lv, container, axis, n, 2. * half[axis]);
+      }
+      mf::LogInfo("PlacementCollapser") << "Collapsed " << n << " placements of " << lv->GetName()
+                                        << " in " << mother->GetName() << " into a "
+                                        << (axis != kUndefined ? "G4PVReplica" : "G4PVParameterised")
+                                        << (container != mother ? " (in envelope " + container->GetName() + ")" : "");
+    }
+  }
+  return envelopes;
+}
@@ -0,0 +1,62 @@
+//=============================================================================
+// PlacementCollapser.h: replaces arrays of identical daughter placements, as
+// produced by the GDML <loop> construct, by a single G4PVReplica or
+// G4PVParameterised volume.
+//
+// Within each mother volume, the G4PVPlacement daughters sharing the same
+// logical volume and rotation are grouped; groups of at least minCopies
+// placements whose copy numbers are 0..N-1 (in any order) are collapsed, so
+// that the copy number seen by sensitive detectors is unchanged:
+//
+//  - if the group is the only content of a box mother and slices it evenly
+//    along one axis, in copy number order, it becomes a G4PVReplica;
+//  - otherwise it becomes a G4PVParameterised with the original positions.
+//    Since a parameterised volume must be the only daughter of its mother,
+//    it is placed in a box envelope of the mother material when the mother
+//    has other daughters; the envelope shares the user limits and field
+//    manager of the mother. Groups whose envelope would overlap the other
+//    daughters are left alone, and so are the groups which would need an
+//    envelope while the mother or the placed volume (or its daughters) are
+//    sensitive, since the envelope would shift the touchable history.
+//
+// Placements with a border surface (G4LogicalBorderSurface) are never
+// collapsed, since the surface refers to them.
+//
+// The parameterised volume keeps the name of the original placements. It is
+// configured in LArG4DetectorService with
+//
+//   CollapsePlacements: {
+//     minCopies:   16     // smallest group to collapse
+//     useReplicas: true   // use G4PVReplica where possible
+//   }
+//=============================================================================
+#ifndef PlacementCollapser_h
+#define PlacementCollapser_h 1
+
+#include "fhiclcpp/ParameterSet.h"
+#include "Geant4/globals.hh"
+
+#include <utility>
+#include <vector>
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  class PlacementCollapser {
+  public:
+    explicit PlacementCollapser(fhicl::ParameterSet const& p);
+
+    // Collapse the arrays of placements below the world volume; returns the
+    // envelope volumes created, each with the mother whose properties it takes
+    std::vector<std::pair<G4LogicalVolume*, G4LogicalVolume*>> collapse(G4VPhysicalVolume* world);
+
+  private:
+    G4int fMinCopies;
+    bool  fUseReplicas;
+  };
+
+}   // namespace larg4
+
+#endif
@@ -0,0 +1,51 @@
+//=============================================================================
+// SensitiveDetectorRegistry.cc: registry of the sensitive detector types,
+// see SensitiveDetectorRegistry.h
+//=============================================================================
+#include "larg4/Services/SensitiveDetectorRegistry.h"
+#include "cetlib/LibraryManager.h"
+#include "cetlib_except/exception.h"
+
+larg4::SensitiveDetectorRegistry& larg4::SensitiveDetectorRegistry::instance() {
+  static SensitiveDetectorRegistry registry;
+  return registry;
+}
+
+larg4::SensitiveDetectorRegistry::SensitiveDetectorRegistry() {
+  registerBuiltinSensitiveDetectors(*this);
+}
+
+void larg4::SensitiveDetectorRegistry::add(std::string const& type, Factory_t factory) {
+  if (!factory.create || !factory.produces || !factory.fill) {
+    throw cet::exception("SensitiveDetectorRegistry") << "Incomplete factory for sensitive detector type "
+                                                      << type << "\n";
+  }
+  if (!factories_.emplace(type, std::move(factory)).second) {
+    throw cet::exception("SensitiveDetectorRegistry") << "Duplicate sensitive detector type "
+                                                      << type << "\n";
+  }
+}
+
+larg4::SensitiveDetectorRegistry::Factory_t const&
+larg4::SensitiveDetectorRegistry::get(std::string const& type) {
+  auto search = factories_.find(type);
+  if (search != factories_.end()) return search->second;
+
+  // -- not a known type: look for a plugin library providing it
+  using register_t = void (*)(SensitiveDetectorRegistry&, std::string const&);
+  register_t registerType = nullptr;
+  try {
+    cet::LibraryManager{"sensdet"}.getSymbolByLibspec(type, "larg4_sensdet_register", registerType);
+  }
+  catch (cet::exception& e) {
+    throw cet::exception("SensitiveDetectorRegistry", "Unknown sensitive detector type " + type + "\n", e);
+  }
+  registerType(*this, type);
+  return factories_.at(type);
+}
+
+std::vector<std::string> larg4::SensitiveDetectorRegistry::types() const {
+  std::vector<std::string> result;
+  for (auto const& entry : factories_) result.push_back(entry.first);
+  return result;
+}
@@ -0,0 +1,95 @@
+//=============================================================================
+// SensitiveDetectorRegistry.h: registry of the sensitive detector types that
+// LArG4DetectorService can attach to the volumes of the geometry.
+//
+// The type of sensitive detector is selected in the GDML file with
+//
+//   <auxiliary auxtype="SensDet" auxvalue="SimEnergyDeposit"/>
+//
+// and each type registers three functions: one creating the sensitive
+// detector (and adding it to the G4SDManager), one declaring the data
+// products it puts into the art event and one putting them there at the end
+// of each event. The product instance name is chosen by the detector service:
+// <prefix><service name><volume>, or only <prefix> for the types registered
+// with perVolume false (HadInteraction, HadIntAndEdepTrk).
+//
+// The built-in types (DRCalorimeter, Calorimeter, PhotonDetector, Tracker,
+// SimEnergyDeposit, AuxDet, HadInteraction, HadIntAndEdepTrk) are always
+// available. Other types can be shipped as separate plugin libraries, built
+// with simple_plugin(<Type> sensdet ...), whose source registers the type with
+//
+//   DEFINE_LARG4_SENSITIVE_DETECTOR(larg4::SensitiveDetectorRegistry::Factory_t{ ... })
+//
+// The library is loaded the first time its type is found in the GDML file.
+// The registry and the built-in types are built as the regular library
+// larg4_Services_SensitiveDetectorRegistry, which such plugins must link.
+// A volume with a type that is neither built in nor provided by a plugin
+// gets no sensitive detector (with a warning in the log).
+//=============================================================================
+#ifndef SensitiveDetectorRegistry_h
+#define SensitiveDetectorRegistry_h 1
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace art {
+  class Event;
+  class ProducesCollector;
+}
+class G4VSensitiveDetector;
+
+namespace larg4 {
+
+  class SensitiveDetectorRegistry {
+  public:
+    // Create the sensitive detector with the given name
+    using create_t   = std::function<G4VSensitiveDetector*(std::string const& sdName)>;
+    // Declare the products of one sensitive detector
+    using produces_t = std::function<void(art::ProducesCollector&, std::string const& instance)>;
+    // Put the products of one sensitive detector into the event
+    using fill_t     = std::function<void(G4VSensitiveDetector*, art::Event&, std::string const& instance)>;
+
+    struct Factory_t {
+      create_t   create;
+      produces_t produces;
+      fill_t     fill;
+      // Whether the products are named after the volume; if not, the
+      // instance name is only the product instance prefix of the service
+      bool       perVolume = true;
+    };
+
+    static SensitiveDetectorRegistry& instance();
+
+    // Register a new type, throws if the type exists already
+    void add(std::string const& type, Factory_t factory);
+
+    // Factory of the type, loading its plugin library if needed; throws if
+    // the type is unknown
+    Factory_t const& get(std::string const& type);
+
+    std::vector<std::string> types() const;
+
+  private:
+    SensitiveDetectorRegistry();
+
+    std::map<std::string, Factory_t> factories_;
+  };
+
+  // Registers the sensitive detectors provided by larg4 and artg4tk
+  void registerBuiltinSensitiveDetectors(SensitiveDetectorRegistry& registry);
+
+}   // namespace larg4
+
+// Entry point of a sensitive detector plugin library
+#define DEFINE_LARG4_SENSITIVE_DETECTOR(factory)                                  \
+  extern "C" {                                                                    \
+    void larg4_sensdet_register(larg4::SensitiveDetectorRegistry& registry,       \
+                                std::string const& type)                          \
+    {                                                                             \
+      registry.add(type, factory);                                                \
+    }                                                                             \
+  }
+
+#endif
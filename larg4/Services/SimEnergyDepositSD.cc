@@ -15,6 +15,7 @@
 #include "larg4/Services/SimEnergyDepositSD.h"
 #include "Geant4/G4HCofThisEvent.hh"
 #include "Geant4/G4Step.hh"
+#include "Geant4/G4Track.hh"
 #include "Geant4/G4ThreeVector.hh"
 #include "Geant4/G4SDManager.hh"
 #include "Geant4/G4ios.hh"
@@ -53,7 +54,10 @@ namespace larg4 {
        if (edep == 0.) return false;
        //std::cout << "7777777777777777:   "<< aStep->GetTotalEnergyDeposit()/CLHEP::MeV << "   " << aStep->GetTotalEnergyDeposit() <<std::endl;
        const int electronsperMeV= 10000;
+       // -- the electrons (and photons) describe the deposit of this one track;
+       //    only the energy carries the weight, which differs from 1 only when biasing is used
        int nrelec=(int)round(edep*electronsperMeV);
+       edep *= aStep->GetTrack()->GetWeight();
        if (aStep->GetTrack()->GetDynamicParticle()->GetCharge() == 0) return false;
        G4int photons = 0;
        G4SteppingManager* fpSteppingManager = G4EventManager::GetEventManager()
@@ -96,4 +100,32 @@ namespace larg4 {
        hitCollection.push_back(newHit);
     return true;
   }// end ProcessHits
+
+  //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+  void   SimEnergyDepositSD::AddLocalDeposit(G4Track const* aTrack) {
+       G4double edep = aTrack->GetKineticEnergy()/CLHEP::MeV;
+       if (edep <= 0.) return;
+       // -- as in ProcessHits, neutral tracks do not ionize
+       if (aTrack->GetDynamicParticle()->GetCharge() == 0) return;
+       const int electronsperMeV= 10000;
+       int nrelec=(int)round(edep*electronsperMeV);
+       edep *= aTrack->GetWeight();
+       geo::Point_t point = geo::Point_t(
+                                         aTrack->GetPosition().x()/CLHEP::cm,
+                                         aTrack->GetPosition().y()/CLHEP::cm,
+                                         aTrack->GetPosition().z()/CLHEP::cm);
+       // -- the killed track never makes it to the particle list: attribute the deposit to its parent
+       sim::SimEnergyDeposit  newHit =  sim::SimEnergyDeposit(0,
+                                                              nrelec,
+                                                              1.0,
+                                                              edep,
+                                                              point,
+                                                              point,
+                                                              aTrack->GetGlobalTime() / CLHEP::ns,
+                                                              aTrack->GetGlobalTime() / CLHEP::ns,
+                                                              aTrack->GetParentID(),
+                                                              aTrack->GetParticleDefinition()->GetPDGEncoding()  );
+       hitCollection.push_back(newHit);
+  }// end AddLocalDeposit
 } // end namespace  larg4
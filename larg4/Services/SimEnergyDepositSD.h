@@ -20,6 +20,7 @@
 #include "lardataobj/Simulation/SimEnergyDeposit.h"
 
 class G4Step;
+class G4Track;
 class G4HCofThisEvent;
 //class SimEnergyDepositCollection;
 
@@ -32,6 +33,9 @@ namespace larg4 {
         ~SimEnergyDepositSD();
         void Initialize(G4HCofThisEvent*);
         G4bool ProcessHits(G4Step*, G4TouchableHistory*);
+        // Record the kinetic energy of a charged track that is killed before
+        // being tracked as a point-like deposit at its creation point
+        void AddLocalDeposit(G4Track const*);
 	const sim::SimEnergyDepositCollection& GetHits() const { return hitCollection; }
     private:
       sim::SimEnergyDepositCollection hitCollection;
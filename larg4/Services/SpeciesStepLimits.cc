@@ -0,0 +1,28 @@
+//=============================================================================
+// SpeciesStepLimits.cc: maximum step by particle species and kinetic energy,
+// see SpeciesStepLimits.h
+//=============================================================================
+#include "larg4/Services/SpeciesStepLimits.h"
+#include "Geant4/G4ParticleDefinition.hh"
+#include "Geant4/G4Track.hh"
+
+#include <algorithm>
+
+larg4::SpeciesStepLimits::SpeciesStepLimits(G4double defaultMaxStep, std::vector<Entry_t> entries)
+  : G4UserLimits(defaultMaxStep),
+    fEntries(std::move(entries))
+{}
+
+larg4::SpeciesStepLimits::~SpeciesStepLimits() {
+}
+
+G4double larg4::SpeciesStepLimits::GetMaxAllowedStep(const G4Track& track) {
+  G4int const pdg = track.GetDefinition()->GetPDGEncoding();
+  G4double const energy = track.GetKineticEnergy();
+  for (auto const& entry : fEntries) {
+    if (energy < entry.minEnergy || energy >= entry.maxEnergy) continue;
+    if (!entry.pdgs.empty() && std::find(entry.pdgs.begin(), entry.pdgs.end(), pdg) == entry.pdgs.end()) continue;
+    return entry.maxStep;
+  }
+  return fMaxStep;
+}
@@ -0,0 +1,46 @@
+//=============================================================================
+// SpeciesStepLimits.h: user limits whose maximum step depends on the particle
+// species and kinetic energy of the track.
+//
+// The limits are a list of (PDG codes, kinetic energy range) -> maximum step
+// entries; the first entry matching the track is used, and tracks matching
+// no entry get the default maximum step of the volume. This allows fine steps
+// where dE/dx varies quickly (low energy electrons, stopping hadrons) and
+// coarse steps for minimum ionising particles in the same volume.
+// As for the plain step limits, the G4StepLimiter process must be enabled in
+// the physics list for the limits to be applied.
+//=============================================================================
+#ifndef SpeciesStepLimits_h
+#define SpeciesStepLimits_h 1
+
+#include "Geant4/G4UserLimits.hh"
+
+#include <vector>
+
+class G4Track;
+
+namespace larg4 {
+
+  class SpeciesStepLimits : public G4UserLimits {
+  public:
+    struct Entry_t {
+      std::vector<int> pdgs;      ///< PDG codes, all species if empty
+      G4double         minEnergy; ///< lower edge of the kinetic energy range
+      G4double         maxEnergy; ///< upper edge of the kinetic energy range
+      G4double         maxStep;   ///< maximum step in the range
+    };
+
+    SpeciesStepLimits(G4double defaultMaxStep, std::vector<Entry_t> entries);
+    virtual ~SpeciesStepLimits();
+
+    G4double GetMaxAllowedStep(const G4Track&) override;
+
+    std::vector<Entry_t> const& GetEntries() const { return fEntries; }
+
+  private:
+    std::vector<Entry_t> fEntries;
+  };
+
+}   // namespace larg4
+
+#endif
@@ -0,0 +1,260 @@
+//=============================================================================
+// WoodcockTrackingModel.cc: Woodcock (delta) tracking of photons inside an
+// envelope volume, see WoodcockTrackingModel.h
+//=============================================================================
+#include "larg4/Services/WoodcockTrackingModel.h"
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+// Geant 4 includes:
+#include "Geant4/G4DynamicParticle.hh"
+#include "Geant4/G4FastStep.hh"
+#include "Geant4/G4FastTrack.hh"
+#include "Geant4/G4Gamma.hh"
+#include "Geant4/G4GeometryTolerance.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Material.hh"
+#include "Geant4/G4ParticleChangeForGamma.hh"
+#include "Geant4/G4PhysicalConstants.hh"
+#include "Geant4/G4ProcessManager.hh"
+#include "Geant4/G4ProcessVector.hh"
+#include "Geant4/G4Step.hh"
+#include "Geant4/G4StepPoint.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4TouchableHandle.hh"
+#include "Geant4/G4TouchableHistory.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/G4TransportationManager.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VProcess.hh"
+#include "Geant4/G4VSensitiveDetector.hh"
+#include "Geant4/G4VSolid.hh"
+#include "Geant4/Randomize.hh"
+
+// C++ includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace {
+  // Photon processes which can be sampled at a real collision
+  std::vector<G4String> const kPhotonProcesses{"phot", "compt", "conv", "Rayl"};
+
+  // Energy range and granularity of the cross-section tables; photons outside
+  // the range get their cross-sections computed on the fly
+  G4double const kTableEmin = 1.*CLHEP::keV;
+  G4double const kTableEmax = 100.*CLHEP::GeV;
+  size_t const kBinsPerDecade = 20;
+}
+
+larg4::WoodcockTrackingModel::WoodcockTrackingModel(G4String const& name,
+                                                    G4Region* envelope,
+                                                    G4LogicalVolume const* envelopeLV)
+  : G4VFastSimulationModel(name, envelope),
+    fXSEnergy(-1.),
+    fMuMax(0.)
+{
+  collectMaterials(envelopeLV);
+  std::stringstream ss;
+  ss << "Woodcock tracking of photons in volume " << envelopeLV->GetName()
+     << ", using the following material(s):";
+  for (auto const* material : fMaterials) ss << " " << material->GetName();
+  mf::LogInfo("WoodcockTrackingModel") << ss.str();
+}
+
+larg4::WoodcockTrackingModel::~WoodcockTrackingModel() {
+}
+
+void larg4::WoodcockTrackingModel::collectMaterials(G4LogicalVolume const* lv) {
+  G4Material const* material = lv->GetMaterial();
+  if (std::find(fMaterials.begin(), fMaterials.end(), material) == fMaterials.end()) {
+    fMaterials.push_back(material);
+  }
+  for (G4int i = 0; i < lv->GetNoDaughters(); ++i) {
+    collectMaterials(lv->GetDaughter(i)->GetLogicalVolume());
+  }
+}
+
+void larg4::WoodcockTrackingModel::findProcesses() {
+  // -- the physics list is only built at the beginning of the run, so this is done at first use
+  G4ProcessVector const* processes = G4Gamma::Gamma()->GetProcessManager()->GetProcessList();
+  for (G4int i = 0; i < (G4int)processes->size(); ++i) {
+    G4VProcess* process = (*processes)[i];
+    if (std::find(kPhotonProcesses.begin(), kPhotonProcesses.end(), process->GetProcessName())
+        != kPhotonProcesses.end()) {
+      fProcesses.push_back(process);
+    }
+  }
+  if (fProcesses.empty()) {
+    throw cet::exception("WoodcockTrackingModel") << "No photon process (phot, compt, conv, Rayl)"
+                                                  << " found in the physics list! The model does not"
+                                                  << " support G4GammaGeneralProcess.\n";
+  }
+  fXS.assign(fMaterials.size(), MaterialXS_t{});
+  for (size_t m = 0; m < fMaterials.size(); ++m) {
+    fXS[m].material = fMaterials[m];
+    fXS[m].perProcess.assign(fProcesses.size(), 0.);
+  }
+  buildTables();
+}
+
+void larg4::WoodcockTrackingModel::buildTables() {
+  size_t const nBins = kBinsPerDecade * std::lround(std::log10(kTableEmax / kTableEmin));
+  G4PhysicsLogVector const grid(kTableEmin, kTableEmax, nBins);
+  for (auto& xs : fXS) {
+    xs.tables.assign(fProcesses.size(), grid);
+    for (size_t p = 0; p < fProcesses.size(); ++p) {
+      for (size_t i = 0; i < grid.GetVectorLength(); ++i) {
+        xs.tables[p].PutValue(i, fCalculator.ComputeCrossSectionPerVolume(grid.Energy(i), G4Gamma::Gamma(),
+                                                                          fProcesses[p]->GetProcessName(),
+                                                                          xs.material));
+      }
+    }
+  }
+}
+
+void larg4::WoodcockTrackingModel::computeCrossSections(G4double energy) {
+  bool const tabulated = (energy >= kTableEmin && energy <= kTableEmax);
+  // -- the largest interpolated coefficient is also the majorant of the
+  // -- interpolated ones, so the rejection below stays exact
+  fMuMax = 0.;
+  for (auto& xs : fXS) {
+    xs.total = 0.;
+    for (size_t p = 0; p < fProcesses.size(); ++p) {
+      xs.perProcess[p] = tabulated ? xs.tables[p].Value(energy)
+                                   : fCalculator.ComputeCrossSectionPerVolume(energy, G4Gamma::Gamma(),
+                                                                              fProcesses[p]->GetProcessName(),
+                                                                              xs.material);
+      xs.total += xs.perProcess[p];
+    }
+    fMuMax = std::max(fMuMax, xs.total);
+  }
+  fXSEnergy = energy;
+}
+
+larg4::WoodcockTrackingModel::MaterialXS_t const*
+larg4::WoodcockTrackingModel::crossSections(G4Material const* material) const {
+  for (auto const& xs : fXS) {
+    if (xs.material == material) return &xs;
+  }
+  return nullptr;
+}
+
+G4bool larg4::WoodcockTrackingModel::IsApplicable(G4ParticleDefinition const& particle) {
+  return &particle == G4Gamma::GammaDefinition();
+}
+
+G4bool larg4::WoodcockTrackingModel::ModelTrigger(G4FastTrack const& fastTrack) {
+  // -- photons sitting on the envelope surface on their way out go back to the standard transport
+  G4double const distanceOut = fastTrack.GetEnvelopeSolid()->DistanceToOut(fastTrack.GetPrimaryTrackLocalPosition(),
+                                                                             fastTrack.GetPrimaryTrackLocalDirection());
+  return distanceOut > G4GeometryTolerance::GetInstance()->GetSurfaceTolerance();
+}
+
+void larg4::WoodcockTrackingModel::DoIt(G4FastTrack const& fastTrack, G4FastStep& fastStep) {
+  if (fProcesses.empty()) findProcesses();
+  if (!fNavigator) {
+    fNavigator = std::make_unique<G4Navigator>();
+    fNavigator->SetWorldVolume(G4TransportationManager::GetTransportationManager()
+                               ->GetNavigatorForTracking()->GetWorldVolume());
+  }
+
+  G4Track const* track = fastTrack.GetPrimaryTrack();
+  G4double const energy = track->GetKineticEnergy();
+  if (energy != fXSEnergy) computeCrossSections(energy);
+
+  G4ThreeVector const& start = track->GetPosition();
+  G4ThreeVector const& direction = track->GetMomentumDirection();
+  G4double const distanceOut = fastTrack.GetEnvelopeSolid()->DistanceToOut(fastTrack.GetPrimaryTrackLocalPosition(),
+                                                                             fastTrack.GetPrimaryTrackLocalDirection());
+
+  G4double travelled = 0.;
+  while (true) {
+    G4double const step = (fMuMax > 0.) ? -std::log(G4UniformRand()) / fMuMax
+                                        : std::numeric_limits<G4double>::max();
+    if (step >= distanceOut - travelled) break;
+    travelled += step;
+
+    // -- decide whether this collision is real or virtual
+    G4ThreeVector const position = start + travelled * direction;
+    G4VPhysicalVolume const* volume = fNavigator->LocateGlobalPointAndSetup(position, &direction, true);
+    MaterialXS_t const* xs = volume ? crossSections(volume->GetLogicalVolume()->GetMaterial()) : nullptr;
+    if (xs && G4UniformRand() * fMuMax < xs->total) {
+      interact(fastTrack, fastStep, *xs, position, direction, energy,
+               track->GetGlobalTime() + travelled / CLHEP::c_light, travelled);
+      return;
+    }
+  }
+
+  // -- no real interaction inside the envelope: move the photon to the exit surface
+  fastStep.ProposePrimaryTrackFinalPosition(start + distanceOut * direction, false);
+  fastStep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + distanceOut / CLHEP::c_light);
+  fastStep.ProposePrimaryTrackPathLength(distanceOut);
+}
+
+void larg4::WoodcockTrackingModel::interact(G4FastTrack const& fastTrack, G4FastStep& fastStep,
+                                            MaterialXS_t const& xs,
+                                            G4ThreeVector const& position, G4ThreeVector const& direction,
+                                            G4double energy, G4double time, G4double pathLength) {
+  // -- pick the process according to its share of the attenuation coefficient
+  G4double const r = G4UniformRand() * xs.total;
+  size_t p = 0;
+  for (G4double sum = xs.perProcess[0]; p + 1 < fProcesses.size() && sum < r; sum += xs.perProcess[++p]) {}
+  G4VProcess* process = fProcesses[p];
+
+  // -- the process needs a track and step located at the interaction point
+  G4Track const* primary = fastTrack.GetPrimaryTrack();
+  auto* particle = new G4DynamicParticle(G4Gamma::Gamma(), direction, energy);
+  particle->SetPolarization(primary->GetPolarization());
+  G4Track track(particle, time, position);
+  track.SetTrackID(primary->GetTrackID());
+  track.SetParentID(primary->GetParentID());
+  track.SetWeight(primary->GetWeight());
+  track.SetTouchableHandle(G4TouchableHandle(fNavigator->CreateTouchableHistory()));
+  G4Step step;
+  step.InitializeStep(&track);
+  track.SetStep(&step);
+
+  G4ForceCondition condition;
+  process->PostStepGetPhysicalInteractionLength(track, 0., &condition);
+  auto* change = dynamic_cast<G4ParticleChangeForGamma*>(process->PostStepDoIt(track, step));
+  if (!change) {
+    throw cet::exception("WoodcockTrackingModel") << "Process " << process->GetProcessName()
+                                                  << " does not use G4ParticleChangeForGamma!\n";
+  }
+
+  fastStep.ProposePrimaryTrackFinalPosition(position, false);
+  fastStep.ProposePrimaryTrackFinalTime(time);
+  fastStep.ProposePrimaryTrackPathLength(pathLength);
+  if (change->GetTrackStatus() == fStopAndKill || change->GetProposedKineticEnergy() <= 0.) {
+    fastStep.KillPrimaryTrack();
+  } else {
+    fastStep.ProposePrimaryTrackFinalKineticEnergy(change->GetProposedKineticEnergy());
+    fastStep.ProposePrimaryTrackFinalMomentumDirection(change->GetProposedMomentumDirection(), false);
+    fastStep.ProposePrimaryTrackFinalPolarization(change->GetProposedPolarization(), false);
+  }
+  // -- the pre-step point of the fast step is where the photon entered the
+  // -- model, not necessarily the cell where it interacted
+  deposit(step, change->GetLocalEnergyDeposit());
+
+  // -- hand the secondaries over to the fast step; note that Geant4 records the
+  // -- fast simulation process as their creator process
+  G4int const nSecondaries = change->GetNumberOfSecondaries();
+  fastStep.SetNumberOfSecondaryTracks(nSecondaries);
+  for (G4int i = 0; i < nSecondaries; ++i) {
+    G4Track* secondary = change->GetSecondary(i);
+    fastStep.CreateSecondaryTrack(*(secondary->GetDynamicParticle()), secondary->GetPosition(),
+                                  secondary->GetGlobalTime(), false);
+    delete secondary;
+  }
+  change->Clear();
+}
+
+void larg4::WoodcockTrackingModel::deposit(G4Step& step, G4double edep) const {
+  if (edep <= 0.) return;
+  G4VPhysicalVolume const* volume = step.GetPreStepPoint()->GetPhysicalVolume();
+  G4VSensitiveDetector* sd = volume ? volume->GetLogicalVolume()->GetSensitiveDetector() : nullptr;
+  if (!sd) return;
+  step.SetTotalEnergyDeposit(edep);
+  sd->Hit(&step);
+}
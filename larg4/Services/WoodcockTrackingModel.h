@@ -0,0 +1,100 @@
+//=============================================================================
+// WoodcockTrackingModel.h: fast simulation model transporting photons through
+// a finely segmented envelope (e.g. an array of calorimeter cells) with
+// Woodcock (delta) tracking.
+//
+// Inside the envelope, the distance to the next collision is sampled with the
+// largest attenuation coefficient found among the materials of the envelope
+// and its daughters, so that the photon does not stop at the internal volume
+// boundaries. At each collision the material is looked up and the collision is
+// accepted as a real interaction with probability mu(material)/mu_max; real
+// interactions are performed by the standard Geant4 photon processes
+// ("phot", "compt", "conv", "Rayl"), rejected ones are virtual and the photon
+// continues unchanged. Photons leaving the envelope are placed on its surface
+// and handed back to the standard transport.
+//
+// The model is attached by LArG4DetectorService to the logical volumes with
+//
+//   <auxiliary auxtype="WoodcockTracking" auxvalue="true"/>
+//
+// in the GDML file (see the commented example in gdml/lArDet.gdml). The tagged
+// volume should be a mother volume enclosing the whole segmented array, since
+// the model does not help in a single cell.
+// The attenuation coefficients are tabulated in log(energy) for each material
+// when the model is first used, and interpolated afterwards. The energy
+// deposited at a real interaction is given to the sensitive detector of the
+// cell where the interaction happened.
+// The individual photon processes must be in the physics list: when
+// G4GammaGeneralProcess is active (the default of the standard EM
+// constructors in recent Geant4 versions) they are not registered for the
+// photon. LArG4DetectorService therefore disables the general process with
+// G4EmParameters::SetGeneralProcessActive(false) as soon as a volume is
+// tagged, before the physics list is built; a physics list forcing it back
+// on makes the model throw at first use.
+//=============================================================================
+#ifndef WoodcockTrackingModel_h
+#define WoodcockTrackingModel_h 1
+
+#include "Geant4/G4VFastSimulationModel.hh"
+#include "Geant4/G4EmCalculator.hh"
+#include "Geant4/G4Navigator.hh"
+#include "Geant4/G4PhysicsLogVector.hh"
+
+#include <memory>
+#include <vector>
+
+class G4LogicalVolume;
+class G4Material;
+class G4ParticleDefinition;
+class G4Region;
+class G4Step;
+class G4VProcess;
+
+namespace larg4 {
+
+  class WoodcockTrackingModel : public G4VFastSimulationModel {
+  public:
+    WoodcockTrackingModel(G4String const& name, G4Region* envelope, G4LogicalVolume const* envelopeLV);
+    virtual ~WoodcockTrackingModel();
+
+    G4bool IsApplicable(G4ParticleDefinition const& particle) override;
+    G4bool ModelTrigger(G4FastTrack const& fastTrack) override;
+    void   DoIt(G4FastTrack const& fastTrack, G4FastStep& fastStep) override;
+
+  private:
+    // Attenuation coefficients of one material
+    struct MaterialXS_t {
+      G4Material const*               material;
+      std::vector<G4PhysicsLogVector> tables;     ///< [1/mm] vs energy, same order as fProcesses
+      std::vector<double>             perProcess; ///< [1/mm] at fXSEnergy, same order as fProcesses
+      double                          total;      ///< [1/mm] at fXSEnergy
+    };
+
+    void collectMaterials(G4LogicalVolume const* lv);
+    void findProcesses();
+    void buildTables();
+    void computeCrossSections(G4double energy);
+    MaterialXS_t const* crossSections(G4Material const* material) const;
+
+    // Perform a real interaction at the given point and fill the fast step
+    void interact(G4FastTrack const& fastTrack, G4FastStep& fastStep, MaterialXS_t const& xs,
+                  G4ThreeVector const& position, G4ThreeVector const& direction,
+                  G4double energy, G4double time, G4double pathLength);
+
+    // Give the energy deposited at a real interaction to the sensitive
+    // detector of the volume it happened in
+    void deposit(G4Step& step, G4double edep) const;
+
+    std::vector<G4Material const*> fMaterials;   ///< materials in the envelope subtree
+    std::vector<MaterialXS_t>      fXS;          ///< cross-section tables, and values at fXSEnergy
+    G4double                       fXSEnergy;    ///< energy at which fXS was computed
+    G4double                       fMuMax;       ///< largest attenuation coefficient at fXSEnergy
+
+    std::vector<G4VProcess*>       fProcesses;   ///< photon processes doing the real interactions
+    G4EmCalculator                 fCalculator;
+    std::unique_ptr<G4Navigator>   fNavigator;   ///< private navigator for material look-ups
+  };
+
+}   // namespace larg4
+
+#endif
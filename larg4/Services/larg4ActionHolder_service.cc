@@ -1,56 +1,94 @@
-// Provides the implementation for the @ActionHolderService@ service.
-// For more comprehensive documentation, see the header file ActionHolderService.hh
+// Provides the implementation for the @larg4ActionHolderService@ service.
+// For more comprehensive documentation, see the header file larg4ActionHolder_service.h
 
 // Authors: Tasha Arvanitis, Adam Lyon
 // Date: July 2012
 
 // Includes
-#include "larg4/Services/larg4ActionHolder_service.hh"
-
-#include "art/Framework/Services/Registry/ServiceMacros.h"
+#include "larg4/Services/larg4ActionHolder_service.h"
 
+#include "cetlib_except/exception.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
-#include "artg4tk/actionBase/RunActionBase.hh"
-#include "artg4tk/actionBase/EventActionBase.hh"
-#include "artg4tk/actionBase/TrackingActionBase.hh"
-#include "artg4tk/actionBase/SteppingActionBase.hh"
-#include "artg4tk/actionBase/StackingActionBase.hh"
-#include "artg4tk/actionBase/PrimaryGeneratorActionBase.hh"
-#include "larg4/actionBase/ParticleListActionBase.h"
+#include "larg4/actionBase/TrackingActionBase.h"
+#include "larg4/actionBase/SteppingActionBase.h"
+#include "larg4/actionBase/StackingActionBase.h"
+
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4Navigator.hh"
+#include "Geant4/G4ParticleDefinition.hh"
+#include "Geant4/G4Step.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/G4TransportationManager.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VTouchable.hh"
+
 #include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
 // Don't type 'std::' all the time...
 using std::string;
 using std::map;
 using std::pair;
 
-
-///////////////////
-using namespace std;
-/////////////////////
 // Message category
 static std::string msgctg = "larg4ActionHolderService";
 
 // Constructor doesn't do much with the passed arguments, but does initialize
 // the logger for the service
-larg4::larg4ActionHolderService::larg4ActionHolderService(fhicl::ParameterSet const&) :
-  runActionsMap_(),
-  eventActionsMap_(),
+larg4::larg4ActionHolderService::larg4ActionHolderService(fhicl::ParameterSet const& p) :
   trackingActionsMap_(),
   steppingActionsMap_(),
   stackingActionsMap_(),
-  primaryGeneratorActionsMap_(),
-  particleListActionsMap_(),
+  singleTrackingAction_(nullptr),
+  singleSteppingAction_(nullptr),
+  singleStackingAction_(nullptr),
   currentArtEvent_(nullptr),
-  allActionsMap_()
-{}
+  currentArtRun_(nullptr),
+  allActionsMap_(),
+  profileActions_(p.get<bool>("ProfileActions", false)),
+  anyPdgMask_(0),
+  lastDefinition_(nullptr),
+  lastPdgMask_(0),
+  useStackingPolicy_(p.has_key("StackingPolicy")),
+  urgentTimeWindow_(std::numeric_limits<G4double>::max()),
+  waitingTimeLimit_(std::numeric_limits<G4double>::max()),
+  waitingEnergyBudget_(std::numeric_limits<G4double>::max()),
+  waitingEnergy_(0.),
+  nWaiting_(0),
+  nDropped_(0),
+  navigator_()
+{
+  for (auto const& subscription : p.get<std::vector<fhicl::ParameterSet>>("SteppingSubscriptions", {})) {
+    subscriptions_[subscription.get<std::string>("action")] = {
+      subscription.get<std::vector<std::string>>("volumes", {}),
+      subscription.get<std::vector<int>>("pdgs", {})};
+  }
+
+  if (useStackingPolicy_) {
+    auto const policy = p.get<fhicl::ParameterSet>("StackingPolicy");
+    urgentVolumeNames_   = policy.get<std::vector<std::string>>("UrgentVolumes", {});
+    urgentTimeWindow_    = policy.get<G4double>("UrgentTimeWindow", urgentTimeWindow_/CLHEP::ns)*CLHEP::ns;
+    waitingTimeLimit_    = policy.get<G4double>("WaitingTimeLimit", waitingTimeLimit_/CLHEP::ns)*CLHEP::ns;
+    waitingEnergyBudget_ = policy.get<G4double>("WaitingEnergyBudget", waitingEnergyBudget_/CLHEP::MeV)*CLHEP::MeV;
+    if (waitingTimeLimit_ < urgentTimeWindow_) {
+      throw cet::exception("larg4ActionHolderService") << "Configuration error: StackingPolicy.WaitingTimeLimit"
+                                                       << " must not be smaller than StackingPolicy.UrgentTimeWindow.\n";
+    }
+  }
+}
 
 
 // Register actions
 template <typename A>
 void larg4::larg4ActionHolderService::doRegisterAction(A * const action,
-						  std::map<std::string, A *>& actionMap)
+						  std::map<std::string, A *>& actionMap,
+						  std::vector<A *>& actions,
+						  std::vector<Profile_t*>& profiles)
 {
    mf::LogDebug(msgctg) << "Registering action " << action->myName();
 
@@ -67,7 +105,7 @@ void larg4::larg4ActionHolderService::doRegisterAction(A * const action,
     // to register in multiple maps). Otherwise, add it.
     if ( 0 == allActionsMap_.count( action->myName() ) ) {
       allActionsMap_.insert(
-        pair<string, ActionBase*>( action->myName(), dynamic_cast<ActionBase*>(action) ));
+        pair<string, artg4tk::ActionBase*>( action->myName(), action ));
     }
   }
 
@@ -77,42 +115,54 @@ void larg4::larg4ActionHolderService::doRegisterAction(A * const action,
     << "Duplicate action named " << action->myName() << ".\n";
   }
 
-}
-
-void larg4::larg4ActionHolderService::registerAction(RunActionBase * const action) {
-  cerr<< "registering to   runActionsMap_"<<endl;
-doRegisterAction(action, runActionsMap_);
+  // Flatten the maps, keeping their order
+  actions.clear();
+  for ( auto const& entry : actionMap ) {
+    actions.push_back(entry.second);
+  }
+  allActions_.clear();
+  for ( auto const& entry : allActionsMap_ ) {
+    allActions_.push_back(entry.second);
+  }
 
+  // The profiles stay parallel to the actions, whenever they are registered
+  if (profileActions_) {
+    profiles.clear();
+    for ( auto* a : actions ) {
+      profiles.push_back(&profiles_[a->myName()]);
+    }
+  }
 }
 
-void larg4::larg4ActionHolderService::registerAction(EventActionBase * const action) {
-  cerr<< "registering to   eventActionsMap_"<<endl;
-  doRegisterAction(action, eventActionsMap_);
+template <typename A>
+void larg4::larg4ActionHolderService::doRegisterAction(A * const action,
+						  std::map<std::string, A *>& actionMap,
+						  std::vector<A *>& actions,
+						  std::vector<Profile_t*>& profiles,
+						  A *& singleAction)
+{
+  doRegisterAction(action, actionMap, actions, profiles);
+  singleAction = (actions.size() == 1) ? actions.front() : nullptr;
 }
 
 void larg4::larg4ActionHolderService::registerAction(TrackingActionBase * const action) {
- cerr<< "registering to   trackingActionsMap_"<<endl;
-  doRegisterAction(action, trackingActionsMap_);
+  doRegisterAction(action, trackingActionsMap_, trackingActions_, trackingProfiles_, singleTrackingAction_);
 }
 
 void larg4::larg4ActionHolderService::registerAction(SteppingActionBase * const action) {
- cerr<< "registering to  steppingActionsMap_"<<endl;
-  doRegisterAction(action, steppingActionsMap_);
+  doRegisterAction(action, steppingActionsMap_, steppingActions_, steppingProfiles_, singleSteppingAction_);
 }
 
 void larg4::larg4ActionHolderService::registerAction(StackingActionBase * const action) {
- cerr<< "registering to  stackingActionsMap_"<<endl;
-  doRegisterAction(action, stackingActionsMap_);
+  doRegisterAction(action, stackingActionsMap_, stackingActions_, stackingProfiles_, singleStackingAction_);
 }
 
-void larg4::larg4ActionHolderService::registerAction(PrimaryGeneratorActionBase * const action) {
- cerr<< "registering to  primaryGeneratorActionsMap_"<<endl;
-  doRegisterAction(action, primaryGeneratorActionsMap_);
-}
-void larg4::larg4ActionHolderService::registerAction(ParticleListActionBase * const action) {
- cerr<< "registering to  particleListActions_"<<endl;
-  doRegisterAction(action, particleListActionsMap_);
+void larg4::larg4ActionHolderService::subscribe(std::string const& steppingActionName,
+                                                std::vector<std::string> const& volumes,
+                                                std::vector<int> const& pdgs) {
+  subscriptions_[steppingActionName] = {volumes, pdgs};
 }
+
 template <typename A>
 A* larg4::larg4ActionHolderService::doGetAction(std::string name, std::map<std::string, A*>& actionMap) {
 
@@ -128,16 +178,6 @@ A* larg4::larg4ActionHolderService::doGetAction(std::string name, std::map<std::
   return actionIter->second;
 }
 
-artg4tk::ActionBase* larg4::larg4ActionHolderService::getAction(std::string name, RunActionBase* out) {
-  out = doGetAction(name, runActionsMap_);
-  return out;
-}
-
-artg4tk::ActionBase* larg4::larg4ActionHolderService::getAction(std::string name, EventActionBase* out) {
-  out = doGetAction(name, eventActionsMap_);
-  return out;
-}
-
 artg4tk::ActionBase* larg4::larg4ActionHolderService::getAction(std::string name, TrackingActionBase* out) {
   out = doGetAction(name, trackingActionsMap_);
   return out;
@@ -153,27 +193,19 @@ artg4tk::ActionBase* larg4::larg4ActionHolderService::getAction(std::string name
   return out;
 }
 
-artg4tk::ActionBase* larg4::larg4ActionHolderService::getAction(std::string name, PrimaryGeneratorActionBase* out) {
-  out = doGetAction(name, primaryGeneratorActionsMap_);
-  return out;
-}
-artg4tk::ActionBase* larg4::larg4ActionHolderService::getAction(std::string name, ParticleListActionBase* out) {
-  out = doGetAction(name, particleListActionsMap_);
-  return out;
-}
 // h3. Art-specific methods
-void larg4::larg4ActionHolderService::callArtProduces(art::EDProducer * prod)
+void larg4::larg4ActionHolderService::callArtProduces(art::ProducesCollector& collector)
 {
 
   // Loop over the "uber" activity map and call @callArtProduces@ on each
-  for ( auto entry : allActionsMap_) {
-    (entry.second)->callArtProduces(prod);
+  for ( auto* action : allActions_ ) {
+    action->callArtProduces(collector);
   }
 }
 
 void larg4::larg4ActionHolderService::initialize() {
-  for ( auto entry : allActionsMap_ ) {
-    (entry.second)->initialize();
+  for ( auto* action : allActions_ ) {
+    action->initialize();
   }
 }
 
@@ -181,90 +213,253 @@ void larg4::larg4ActionHolderService::fillEventWithArtStuff()
 {
 
   // Loop over the "uber" activity map and call @fillEventWithArtStuff@ on each
-  for ( auto entry : allActionsMap_ ) {
-    (entry.second)->fillEventWithArtStuff(getCurrArtEvent());
+  for ( auto* action : allActions_ ) {
+    action->fillEventWithArtStuff(getCurrArtEvent());
   }
 }
 
 void larg4::larg4ActionHolderService::fillRunBeginWithArtStuff()
 {
   // Loop over the activities and call @fillRunBeginWithArtStuff@ on each
-  for ( auto entry : allActionsMap_ ) {
-    (entry.second)->fillRunBeginWithArtStuff(getCurrArtRun());
+  for ( auto* action : allActions_ ) {
+    action->fillRunBeginWithArtStuff(getCurrArtRun());
   }
 }
 
 void larg4::larg4ActionHolderService::fillRunEndWithArtStuff()
 {
   // Loop over the activities and call @fillRunEndWithArtStuff@ on each
-  for ( auto entry : allActionsMap_ ) {
-    (entry.second)->fillRunEndWithArtStuff(getCurrArtRun());
+  for ( auto* action : allActions_ ) {
+    action->fillRunEndWithArtStuff(getCurrArtRun());
   }
 }
 
+// h2. Profiling
+template <typename A, typename F>
+void larg4::larg4ActionHolderService::profiledCall(std::vector<A*> const& actions,
+                                                   std::vector<Profile_t*> const& profiles,
+                                                   Hook_t hook, F call)
+{
+  for ( size_t i = 0; i < actions.size(); ++i ) {
+    auto const start = profile_clock::now();
+    call(actions[i]);
+    Counter_t& counter = (*profiles[i])[hook];
+    counter.time += profile_clock::now() - start;
+    ++counter.calls;
+  }
+}
+
+void larg4::larg4ActionHolderService::reportProfiles() const
+{
+  static char const* const hookNames[kNHooks] = {
+    "preTracking", "postTracking", "stepping", "killNewTrack"};
+
+  std::ostringstream ss;
+  ss << "Action profile for this run:\n"
+     << std::left << std::setw(40) << "action" << std::setw(20) << "hook" << std::right
+     << std::setw(14) << "calls" << std::setw(14) << "total [ms]" << std::setw(12) << "mean [ns]" << "\n";
+  for ( auto const& [name, profile] : profiles_ ) {
+    for ( int hook = 0; hook < kNHooks; ++hook ) {
+      Counter_t const& counter = profile[hook];
+      if (counter.calls == 0) continue;
+      ss << std::left << std::setw(40) << name << std::setw(20) << hookNames[hook] << std::right
+         << std::setw(14) << counter.calls
+         << std::setw(14) << std::fixed << std::setprecision(1) << counter.time.count() * 1.e-6
+         << std::setw(12) << double(counter.time.count()) / counter.calls << "\n";
+    }
+  }
+  mf::LogInfo(msgctg) << ss.str();
+}
+
 // h2. Action methods
 
 // I tried to be good and use @std::for_each@ but it got really messy very
 // quickly. Oh well.
 
-// h3. Run action methods
-void larg4::larg4ActionHolderService::beginOfRunAction(const G4Run* theRun) {
+// h3. Run hooks
+void larg4::larg4ActionHolderService::beginOfRunAction(const G4Run*) {
 
-  // Loop over the runActionsMap and call @beginOfRunAction@ on each
-  for ( auto entry : runActionsMap_ ) {
-    (entry.second)->beginOfRunAction(theRun);
+  // The stacking policy volumes can only be resolved once the geometry exists
+  urgentVolumes_.clear();
+  for (auto const& name : urgentVolumeNames_) {
+    G4LogicalVolume const* lv = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!lv) {
+      throw cet::exception("larg4ActionHolderService") << "StackingPolicy: urgent volume "
+                                                       << name << " not found!\n";
+    }
+    urgentVolumes_.insert(lv);
   }
-}
+  navigator_.reset();
+  nWaiting_ = 0;
+  nDropped_ = 0;
 
-void larg4::larg4ActionHolderService::endOfRunAction(const G4Run* theRun) {
+  if (!subscriptions_.empty()) {
+    buildSubscriptionMasks();
+  }
 
-  // Loop over the runActionsMap and call @endOfRunAction@ on each
-  for ( auto entry : runActionsMap_ ) {
-    (entry.second)->endOfRunAction(theRun);
+  if (profileActions_) {
+    for ( auto& entry : profiles_ ) {
+      entry.second = Profile_t{};
+    }
   }
 }
 
-// h3. Event action methods
-void larg4::larg4ActionHolderService::beginOfEventAction(const G4Event* theEvent) {
-  for ( auto entry : eventActionsMap_ ) {
-    (entry.second)->beginOfEventAction(theEvent);
+void larg4::larg4ActionHolderService::endOfRunAction(const G4Run*) {
+
+  if (useStackingPolicy_) {
+    mf::LogInfo(msgctg) << "Stacking policy: " << nWaiting_ << " track(s) deferred to the waiting stack, "
+                        << nDropped_ << " of which were dropped.";
   }
-}
 
-void larg4::larg4ActionHolderService::endOfEventAction(const G4Event* theEvent) {
-  for ( auto entry : eventActionsMap_ ) {
-    (entry.second)->endOfEventAction(theEvent);
+  if (profileActions_) {
+    reportProfiles();
   }
 }
 
 // h3. Tracking action methods
 void larg4::larg4ActionHolderService::preUserTrackingAction(const G4Track* theTrack) {
-  for ( auto entry : trackingActionsMap_ ) {
-    (entry.second)->preUserTrackingAction(theTrack);
+  if (profileActions_) {
+    profiledCall(trackingActions_, trackingProfiles_, kPreTracking, [theTrack](auto* a) { a->preUserTrackingAction(theTrack); });
+    return;
+  }
+  if (singleTrackingAction_) {
+    singleTrackingAction_->preUserTrackingAction(theTrack);
+    return;
+  }
+  for ( auto* action : trackingActions_ ) {
+    action->preUserTrackingAction(theTrack);
   }
 
 }
 
 void larg4::larg4ActionHolderService::postUserTrackingAction(const G4Track* theTrack) {
-  for (auto entry : trackingActionsMap_ ) {
-    (entry.second)->postUserTrackingAction(theTrack);
+  if (profileActions_) {
+    profiledCall(trackingActions_, trackingProfiles_, kPostTracking, [theTrack](auto* a) { a->postUserTrackingAction(theTrack); });
+    return;
+  }
+  if (singleTrackingAction_) {
+    singleTrackingAction_->postUserTrackingAction(theTrack);
+    return;
+  }
+  for ( auto* action : trackingActions_ ) {
+    action->postUserTrackingAction(theTrack);
   }
 }
 
 // h3. Stepping actions
 void larg4::larg4ActionHolderService::userSteppingAction(const G4Step* theStep) {
-  for ( auto entry : steppingActionsMap_ ) {
-    (entry.second)->userSteppingAction(theStep);
+  if (!subscriptions_.empty()) {
+    subscribedSteppingAction(theStep);
+    return;
+  }
+  if (profileActions_) {
+    profiledCall(steppingActions_, steppingProfiles_, kStepping, [theStep](auto* a) { a->userSteppingAction(theStep); });
+    return;
+  }
+  if (singleSteppingAction_) {
+    singleSteppingAction_->userSteppingAction(theStep);
+    return;
+  }
+  for ( auto* action : steppingActions_ ) {
+    action->userSteppingAction(theStep);
+  }
+}
+
+void larg4::larg4ActionHolderService::buildSubscriptionMasks() {
+  if (steppingActions_.size() > 64) {
+    throw cet::exception("larg4ActionHolderService") << "SteppingSubscriptions: at most 64 stepping"
+                                                     << " actions are supported, found "
+                                                     << steppingActions_.size() << ".\n";
+  }
+  for (auto const& entry : subscriptions_) {
+    if (!steppingActionsMap_.count(entry.first)) {
+      throw cet::exception("larg4ActionHolderService") << "SteppingSubscriptions: no stepping action named "
+                                                       << entry.first << ".\n";
+    }
+  }
+
+  G4LogicalVolumeStore const* lvStore = G4LogicalVolumeStore::GetInstance();
+  G4int maxID = -1;
+  for (auto const* lv : *lvStore) maxID = std::max(maxID, lv->GetInstanceID());
+
+  std::uint64_t anyVolumeMask = 0;
+  volumeMasks_.assign(maxID + 1, 0);
+  anyPdgMask_ = 0;
+  pdgMasks_.clear();
+  for (size_t i = 0; i < steppingActions_.size(); ++i) {
+    std::uint64_t const bit = std::uint64_t(1) << i;
+    auto search = subscriptions_.find(steppingActions_[i]->myName());
+    if (search == subscriptions_.end() || search->second.volumes.empty()) {
+      anyVolumeMask |= bit;
+    } else {
+      for (auto const& name : search->second.volumes) {
+        G4LogicalVolume const* lv = lvStore->GetVolume(name, false);
+        if (!lv) {
+          throw cet::exception("larg4ActionHolderService") << "SteppingSubscriptions: volume "
+                                                           << name << " not found!\n";
+        }
+        volumeMasks_[lv->GetInstanceID()] |= bit;
+      }
+    }
+    if (search == subscriptions_.end() || search->second.pdgs.empty()) {
+      anyPdgMask_ |= bit;
+    } else {
+      for (int pdg : search->second.pdgs) pdgMasks_[pdg] |= bit;
+    }
+  }
+  for (auto& mask : volumeMasks_) mask |= anyVolumeMask;
+  lastDefinition_ = nullptr;
+}
+
+void larg4::larg4ActionHolderService::subscribedSteppingAction(const G4Step* theStep) {
+  // The particle rarely changes from one step to the next
+  G4ParticleDefinition const* definition = theStep->GetTrack()->GetDefinition();
+  if (definition != lastDefinition_) {
+    auto search = pdgMasks_.find(definition->GetPDGEncoding());
+    lastPdgMask_ = anyPdgMask_ | (search == pdgMasks_.end() ? 0 : search->second);
+    lastDefinition_ = definition;
+  }
+  G4LogicalVolume const* lv = theStep->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume();
+  std::uint64_t mask = volumeMasks_[lv->GetInstanceID()] & lastPdgMask_;
+
+  for ( size_t i = 0; mask != 0; ++i, mask >>= 1 ) {
+    if (!(mask & 1)) continue;
+    if (profileActions_) {
+      auto const start = profile_clock::now();
+      steppingActions_[i]->userSteppingAction(theStep);
+      Counter_t& counter = (*steppingProfiles_[i])[kStepping];
+      counter.time += profile_clock::now() - start;
+      ++counter.calls;
+    } else {
+      steppingActions_[i]->userSteppingAction(theStep);
+    }
   }
 }
 
 // h3. Stacking actions
 bool larg4::larg4ActionHolderService::killNewTrack(const G4Track* newTrack) {
 
+  if (profileActions_) {
+    // The first action killing the track stops the loop, as below
+    for ( size_t i = 0; i < stackingActions_.size(); ++i ) {
+      auto const start = profile_clock::now();
+      bool const kill = stackingActions_[i]->killNewTrack(newTrack);
+      Counter_t& counter = (*stackingProfiles_[i])[kKillNewTrack];
+      counter.time += profile_clock::now() - start;
+      ++counter.calls;
+      if (kill) return true;
+    }
+    return false;
+  }
+
+  if (singleStackingAction_) {
+    return singleStackingAction_->killNewTrack(newTrack);
+  }
+
   bool killTrack = false;
 
-  for (auto entry : stackingActionsMap_) {
-    if ( (entry.second)->killNewTrack(newTrack) ) {
+  for ( auto* action : stackingActions_ ) {
+    if ( action->killNewTrack(newTrack) ) {
       killTrack = true;
       break;
     }
@@ -273,13 +468,44 @@ bool larg4::larg4ActionHolderService::killNewTrack(const G4Track* newTrack) {
   return killTrack;
 }
 
-// h3. Primary generator actions
-void larg4::larg4ActionHolderService::generatePrimaries(G4Event* theEvent) {
-  for ( auto entry : primaryGeneratorActionsMap_ ) {
-    (entry.second)->generatePrimaries(theEvent);
+G4ClassificationOfNewTrack larg4::larg4ActionHolderService::classifyNewTrack(const G4Track* newTrack) {
+
+  if (killNewTrack(newTrack)) return fKill;
+  if (!useStackingPolicy_ || newTrack->GetParentID() == 0) return fUrgent;
+
+  G4double const time = newTrack->GetGlobalTime();
+  if (time <= urgentTimeWindow_ && (urgentVolumes_.empty() || inUrgentVolume(newTrack))) return fUrgent;
+
+  // Deferred track: drop it if it is beyond the time or energy budget
+  ++nWaiting_;
+  G4double const energy = newTrack->GetKineticEnergy();
+  if (time > waitingTimeLimit_ || waitingEnergy_ + energy > waitingEnergyBudget_) {
+    ++nDropped_;
+    return fKill;
   }
+  waitingEnergy_ += energy;
+  return fWaiting;
 }
 
+void larg4::larg4ActionHolderService::prepareNewEvent() {
+  waitingEnergy_ = 0.;
+}
+
+bool larg4::larg4ActionHolderService::inUrgentVolume(const G4Track* newTrack) {
+  G4VPhysicalVolume const* volume = nullptr;
+  if (newTrack->GetTouchable()) {
+    volume = newTrack->GetTouchable()->GetVolume();
+  } else {
+    // Primaries and some secondaries have no touchable yet
+    if (!navigator_) {
+      navigator_ = std::make_unique<G4Navigator>();
+      navigator_->SetWorldVolume(G4TransportationManager::GetTransportationManager()
+                                 ->GetNavigatorForTracking()->GetWorldVolume());
+    }
+    volume = navigator_->LocateGlobalPointAndSetup(newTrack->GetPosition(), nullptr, false, true);
+  }
+  return volume && urgentVolumes_.count(volume->GetLogicalVolume());
+}
 
 // Register the service with Art
 using larg4::larg4ActionHolderService;
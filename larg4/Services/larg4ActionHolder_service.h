@@ -1,79 +1,132 @@
-// Declarations for the @ActionHolderService@ Art service.
-
-// @ActionHolderService@ is a globally-accessible service that manages the action
-// objects for a simulation. An action object has a multitude of hooks into
-// various points during event creation and processing. All action objects
-// must be registered with this service in order to function.
-
-// Any class can @#include@ and access the @ActionHolderService@ service to get either
-// a collection of registered action objects or a specific action object given
-// a name.
+// Declarations for the @larg4ActionHolderService@ Art service.
+
+// @larg4ActionHolderService@ is the counterpart of artg4tk's
+// @ActionHolderService@ for the actions called for every track and step:
+// tracking, stepping and stacking actions deriving from
+// larg4::TrackingActionBase, larg4::SteppingActionBase and
+// larg4::StackingActionBase (in larg4/actionBase) register with this service
+// instead. Run, event and primary generator actions stay with artg4tk's
+// service. larg4Main installs Geant4 user actions (see larg4UserActions.h)
+// which call the artg4tk actions first, then the ones held here, so the
+// service must be configured whenever larg4Main runs:
+//
+// services: {
+//   ...
+//     larg4ActionHolder: {}
+//     ...
+// }
+//
+// Any class can @#include@ and access the service to get a specific action
+// object given a name.
 
 // Authors: Tasha Arvanitis, Adam Lyon
 // Date: July 2012
 
+// New tracks can be routed to the urgent or waiting stack according to an
+// optional stacking policy, configured with a table in the service parameters:
+//
+//   StackingPolicy: {
+//     UrgentVolumes:       [ "volTPCActiveInner" ] // logical volumes tracked first
+//     UrgentTimeWindow:    1.e4                    // [ns] later tracks are deferred
+//     WaitingTimeLimit:    1.e6                    // [ns] later deferred tracks are dropped
+//     WaitingEnergyBudget: 1.e5                    // [MeV] per event, beyond it deferred tracks are dropped
+//   }
+//
+// Primaries, and tracks created inside one of the urgent volumes within the
+// urgent time window, go to the urgent stack; all the other tracks go to the
+// waiting stack, which Geant4 only processes once the urgent stack is empty.
+// Without the table, every track that is not killed goes to the urgent stack.
+//
+// Stepping actions can be subscribed to a set of logical volumes and/or PDG
+// codes, either by calling subscribe() after they are registered or with
+//
+//   SteppingSubscriptions: [
+//     { action: "KillerVolumeActionServiceSteppingAction" volumes: [ "volCryostat" ] },
+//     { action: "MyMuonAction" pdgs: [ 13, -13 ] }
+//   ]
+//
+// where "action" is the name the stepping action registers with (e.g.
+// KillerVolumeActionService registers "<name>SteppingAction"). A subscribed
+// action is only called for the steps starting in one of its volumes, by a
+// particle with one of its PDG codes (an empty list matches everything). The
+// subscriptions are turned into bitmasks over the stepping actions in
+// beginOfRunAction(), which the run action installed by larg4Main
+// (LArG4RunAction) calls once the geometry is built: one mask per logical
+// volume, indexed by its instance ID, and one per PDG code; at most 64
+// stepping actions can be registered when subscriptions are used.
+//
+// With "ProfileActions: true", each call of an action hook is counted and
+// timed, and a table of the calls and time per action and hook is written to
+// the log at the end of each run.
+
 // Include guard
-#ifndef LARG4ACTION_HOLDER_SERVICE_HH
-#define LARG4ACTION_HOLDER_SERVICE_HH
+#ifndef LARG4ACTION_HOLDER_SERVICE_H
+#define LARG4ACTION_HOLDER_SERVICE_H
 
 // Includes
 #include "fhiclcpp/ParameterSet.h"
-#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/ProducesCollector.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Run.h"
+#include "art/Framework/Services/Registry/ServiceMacros.h"
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Geant4/G4ClassificationOfNewTrack.hh"
+#include "Geant4/globals.hh"
 
 class G4Run;
-class G4Event;
 class G4Track;
 class G4Step;
+class G4LogicalVolume;
+class G4Navigator;
+class G4ParticleDefinition;
 
 #include "artg4tk/actionBase/ActionBase.hh"
 
-// Everything for the Art G4 simulation goes in the @artg4tk@ namespace
 namespace larg4 {
 
-  class RunActionBase;
-  class EventActionBase;
   class TrackingActionBase;
   class SteppingActionBase;
   class StackingActionBase;
-  class PrimaryGeneratorActionBase;
-  class ParticleListActionBase;
   class larg4ActionHolderService {
   public:
     // Constructor for larg4ActionHolderService
     larg4ActionHolderService(fhicl::ParameterSet const &);
 
     // This method registers the passed action object with the service
-    void registerAction(RunActionBase * const action);
-    void registerAction(EventActionBase* const action);
     void registerAction(TrackingActionBase* const action);
     void registerAction(SteppingActionBase* const action);
     void registerAction(StackingActionBase* const action);
-    void registerAction(PrimaryGeneratorActionBase* const action);
-    void registerAction(ParticleListActionBase* const action);
+
+    // Call the named stepping action only for steps in the given logical
+    // volumes and by particles with the given PDG codes (empty: any)
+    void subscribe(std::string const& steppingActionName,
+                   std::vector<std::string> const& volumes, std::vector<int> const& pdgs);
     // Get an action
-    artg4tk::ActionBase* getAction(std::string name, RunActionBase* out);
-    artg4tk::ActionBase* getAction(std::string name, EventActionBase* out);
     artg4tk::ActionBase* getAction(std::string name, TrackingActionBase* out);
     artg4tk::ActionBase* getAction(std::string name, SteppingActionBase* out);
     artg4tk::ActionBase* getAction(std::string name, StackingActionBase* out);
-    artg4tk::ActionBase* getAction(std::string name, PrimaryGeneratorActionBase* out);
-    artg4tk::ActionBase* getAction(std::string name, ParticleListActionBase* out);
     // h3. Art-specific methods
 
     // Call ActionBase::initialize for each action
     void initialize();
 
     // Tell each action to notify Art of what it will be producing.
-    void callArtProduces(art::EDProducer * prod);
+    void callArtProduces(art::ProducesCollector& collector);
 
     // Tell each action to dump anything it likes into the Art event
     void fillEventWithArtStuff();
 
-    // Tell the run actions to dump their stuff into the Art run
+    // Tell the actions to dump their stuff into the Art run
     void fillRunBeginWithArtStuff();
     void fillRunEndWithArtStuff();
 
@@ -88,14 +141,11 @@ namespace larg4 {
 
     // h3. Action methods
 
-    // h4. Run Actions
+    // h4. Run hooks: set up the stacking policy and the subscriptions,
+    // report the profiles
     void beginOfRunAction(const G4Run* );
     void endOfRunAction(const G4Run* );
 
-    // h4. Event Actions
-    void beginOfEventAction(const G4Event* );
-    void endOfEventAction(const G4Event* );
-
     // h4. Tracking actions
     void preUserTrackingAction(const G4Track* );
     void postUserTrackingAction(const G4Track* );
@@ -105,21 +155,30 @@ namespace larg4 {
 
     // h4. Stacking actions
     bool killNewTrack(const G4Track* );
-
-    // h4. Primary Generator actions
-    void generatePrimaries(G4Event*);
+    G4ClassificationOfNewTrack classifyNewTrack(const G4Track* );
+    void prepareNewEvent();
 
 
   private:
 
-    // A collection of all our actions, arranged by name
-    std::map<std::string, RunActionBase*> runActionsMap_;
-    std::map<std::string, EventActionBase*> eventActionsMap_;
+    // A collection of all our actions, arranged by name; the actions are looked
+    // up by name here, but called through the vectors below
     std::map<std::string, TrackingActionBase*> trackingActionsMap_;
     std::map<std::string, SteppingActionBase*> steppingActionsMap_;
     std::map<std::string, StackingActionBase*> stackingActionsMap_;
-    std::map<std::string, PrimaryGeneratorActionBase*> primaryGeneratorActionsMap_;
-    std::map<std::string, ParticleListActionBase*> particleListActionsMap_;
+
+    // The same actions in contiguous vectors (in the order of the maps), rebuilt
+    // at each registration, so that the hooks called for every track and step
+    // do not walk the maps
+    std::vector<TrackingActionBase*> trackingActions_;
+    std::vector<SteppingActionBase*> steppingActions_;
+    std::vector<StackingActionBase*> stackingActions_;
+    std::vector<artg4tk::ActionBase*> allActions_;
+
+    // The only action of its kind, if exactly one is registered (nullptr otherwise)
+    TrackingActionBase* singleTrackingAction_;
+    SteppingActionBase* singleSteppingAction_;
+    StackingActionBase* singleStackingAction_;
     // Hold on to the current Art event
     art::Event * currentArtEvent_;
 
@@ -129,9 +188,72 @@ namespace larg4 {
     // An uber-collection of all registered actions, arranged by name
     std::map<std::string, artg4tk::ActionBase*> allActionsMap_;
 
+    // Profiling of the action hooks, see the description at the top of this file
+    enum Hook_t { kPreTracking, kPostTracking, kStepping, kKillNewTrack, kNHooks };
+    struct Counter_t {
+      unsigned long            calls = 0;
+      std::chrono::nanoseconds time{0};
+    };
+    using Profile_t = std::array<Counter_t, kNHooks>;
+    using profile_clock = std::chrono::steady_clock;
+
+    bool                             profileActions_;
+    std::map<std::string, Profile_t> profiles_;                   // by action name
+    std::vector<Profile_t*>          trackingProfiles_;           // parallel to trackingActions_, ...
+    std::vector<Profile_t*>          steppingProfiles_;
+    std::vector<Profile_t*>          stackingProfiles_;
+
+    // Call the hook of each action, counting and timing the calls
+    template <typename A, typename F>
+    void profiledCall(std::vector<A*> const& actions, std::vector<Profile_t*> const& profiles,
+                      Hook_t hook, F call);
+
+    // Write the profile table to the log
+    void reportProfiles() const;
+
+    // Stepping action subscriptions, see the description at the top of this file
+    struct Subscription_t {
+      std::vector<std::string> volumes;
+      std::vector<int>         pdgs;
+    };
+    std::map<std::string, Subscription_t>      subscriptions_;     // by stepping action name
+    std::vector<std::uint64_t>                 volumeMasks_;       // by logical volume instance ID
+    std::uint64_t                              anyPdgMask_;        // actions without PDG subscription
+    std::unordered_map<int, std::uint64_t>     pdgMasks_;          // by PDG code
+    G4ParticleDefinition const*                lastDefinition_;    // particle of the last masked step
+    std::uint64_t                              lastPdgMask_;       // and its PDG mask
+
+    // Build the bitmasks once the geometry exists
+    void buildSubscriptionMasks();
+
+    // Call the stepping actions subscribed to the step
+    void subscribedSteppingAction(const G4Step* );
+
+    // Stacking policy, see the description at the top of this file
+    bool                                       useStackingPolicy_;
+    std::vector<std::string>                   urgentVolumeNames_;
+    std::unordered_set<G4LogicalVolume const*> urgentVolumes_;
+    G4double                                   urgentTimeWindow_;    // [ns]
+    G4double                                   waitingTimeLimit_;    // [ns]
+    G4double                                   waitingEnergyBudget_; // [MeV]
+    G4double                                   waitingEnergy_;       // [MeV] sent to the waiting stack in this event
+    unsigned long                              nWaiting_;            // tracks deferred in this run
+    unsigned long                              nDropped_;            // deferred tracks dropped in this run
+    std::unique_ptr<G4Navigator>               navigator_;           // locates new tracks without a touchable
+
+    // Whether the new track starts in one of the urgent volumes
+    bool inUrgentVolume(const G4Track* );
+
     // Register the action
     template <typename A>
-    void doRegisterAction(A * const action, std::map<std::string, A *>& actionMap);
+    void doRegisterAction(A * const action, std::map<std::string, A *>& actionMap,
+                          std::vector<A *>& actions, std::vector<Profile_t*>& profiles);
+
+    // Register the action, keeping track of a single action of its kind
+    template <typename A>
+    void doRegisterAction(A * const action, std::map<std::string, A *>& actionMap,
+                          std::vector<A *>& actions, std::vector<Profile_t*>& profiles,
+                          A *& singleAction);
 
     // Get an action
     template <typename A>
@@ -143,4 +265,4 @@ namespace larg4 {
 using larg4::larg4ActionHolderService;
 DECLARE_ART_SERVICE(larg4ActionHolderService, LEGACY)
 
-#endif // ACTION_HOLDER_HH
+#endif // LARG4ACTION_HOLDER_SERVICE_H
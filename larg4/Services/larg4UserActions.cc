@@ -0,0 +1,60 @@
+// Geant4 user actions of larg4Main, see larg4UserActions.h
+
+#include "larg4/Services/larg4UserActions.h"
+#include "larg4/Services/larg4ActionHolder_service.h"
+
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+
+namespace {
+  larg4::larg4ActionHolderService* holder() {
+    return art::ServiceHandle<larg4::larg4ActionHolderService>().get();
+  }
+}
+
+larg4::LArG4RunAction::LArG4RunAction() : holder_(holder()) {}
+larg4::LArG4EventAction::LArG4EventAction() : holder_(holder()) {}
+larg4::LArG4TrackingAction::LArG4TrackingAction() : holder_(holder()) {}
+larg4::LArG4SteppingAction::LArG4SteppingAction() : holder_(holder()) {}
+larg4::LArG4StackingAction::LArG4StackingAction() : holder_(holder()) {}
+
+void larg4::LArG4RunAction::BeginOfRunAction(const G4Run* currentRun) {
+  artg4tk::ArtG4RunAction::BeginOfRunAction(currentRun);
+  holder_->beginOfRunAction(currentRun);
+  holder_->fillRunBeginWithArtStuff();
+}
+
+void larg4::LArG4RunAction::EndOfRunAction(const G4Run* currentRun) {
+  artg4tk::ArtG4RunAction::EndOfRunAction(currentRun);
+  holder_->endOfRunAction(currentRun);
+  holder_->fillRunEndWithArtStuff();
+}
+
+void larg4::LArG4EventAction::EndOfEventAction(const G4Event* currentEvent) {
+  artg4tk::ArtG4EventAction::EndOfEventAction(currentEvent);
+  holder_->fillEventWithArtStuff();
+}
+
+void larg4::LArG4TrackingAction::PreUserTrackingAction(const G4Track* currentTrack) {
+  artg4tk::ArtG4TrackingAction::PreUserTrackingAction(currentTrack);
+  holder_->preUserTrackingAction(currentTrack);
+}
+
+void larg4::LArG4TrackingAction::PostUserTrackingAction(const G4Track* currentTrack) {
+  artg4tk::ArtG4TrackingAction::PostUserTrackingAction(currentTrack);
+  holder_->postUserTrackingAction(currentTrack);
+}
+
+void larg4::LArG4SteppingAction::UserSteppingAction(const G4Step* currentStep) {
+  artg4tk::ArtG4SteppingAction::UserSteppingAction(currentStep);
+  holder_->userSteppingAction(currentStep);
+}
+
+G4ClassificationOfNewTrack larg4::LArG4StackingAction::ClassifyNewTrack(const G4Track* currentTrack) {
+  if (artg4tk::ArtG4StackingAction::ClassifyNewTrack(currentTrack) == fKill) return fKill;
+  return holder_->classifyNewTrack(currentTrack);
+}
+
+void larg4::LArG4StackingAction::PrepareNewEvent() {
+  artg4tk::ArtG4StackingAction::PrepareNewEvent();
+  holder_->prepareNewEvent();
+}
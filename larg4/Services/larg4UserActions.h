@@ -0,0 +1,77 @@
+// larg4UserActions: the Geant4 user actions installed by larg4Main. Each one
+// calls the corresponding artg4tk user action (which dispatches to the actions
+// registered with artg4tk's ActionHolderService), then the actions registered
+// with larg4ActionHolderService. New tracks not killed by any stacking action
+// are classified by the stacking policy of larg4ActionHolderService.
+// The service is looked up once, when the user action is created.
+
+// Include guard
+#ifndef LARG4USERACTIONS_H
+#define LARG4USERACTIONS_H
+
+#include "artg4tk/geantInit/ArtG4EventAction.hh"
+#include "artg4tk/geantInit/ArtG4RunAction.hh"
+#include "artg4tk/geantInit/ArtG4StackingAction.hh"
+#include "artg4tk/geantInit/ArtG4SteppingAction.hh"
+#include "artg4tk/geantInit/ArtG4TrackingAction.hh"
+
+namespace larg4 {
+
+  class larg4ActionHolderService;
+
+  class LArG4RunAction : public artg4tk::ArtG4RunAction {
+  public:
+    LArG4RunAction();
+
+    void BeginOfRunAction(const G4Run* currentRun) override;
+    void EndOfRunAction(const G4Run* currentRun) override;
+
+  private:
+    larg4ActionHolderService* holder_;
+  };
+
+  class LArG4EventAction : public artg4tk::ArtG4EventAction {
+  public:
+    LArG4EventAction();
+
+    void EndOfEventAction(const G4Event* currentEvent) override;
+
+  private:
+    larg4ActionHolderService* holder_;
+  };
+
+  class LArG4TrackingAction : public artg4tk::ArtG4TrackingAction {
+  public:
+    LArG4TrackingAction();
+
+    void PreUserTrackingAction(const G4Track* currentTrack) override;
+    void PostUserTrackingAction(const G4Track* currentTrack) override;
+
+  private:
+    larg4ActionHolderService* holder_;
+  };
+
+  class LArG4SteppingAction : public artg4tk::ArtG4SteppingAction {
+  public:
+    LArG4SteppingAction();
+
+    void UserSteppingAction(const G4Step* currentStep) override;
+
+  private:
+    larg4ActionHolderService* holder_;
+  };
+
+  class LArG4StackingAction : public artg4tk::ArtG4StackingAction {
+  public:
+    LArG4StackingAction();
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* currentTrack) override;
+    void PrepareNewEvent() override;
+
+  private:
+    larg4ActionHolderService* holder_;
+  };
+
+} // namespace larg4
+
+#endif
@@ -0,0 +1,37 @@
+// larg4::StackingActionBase is the base class of the stacking actions called
+// through larg4ActionHolderService (see larg4ActionHolder_service.h) rather
+// than artg4tk's ActionHolderService. It mirrors
+// artg4tk::StackingActionBase, and registers the action with
+// larg4ActionHolderService on construction; the tracks it does not kill are
+// then classified by the stacking policy of the service.
+
+// Include guard
+#ifndef LARG4_STACKINGACTIONBASE_H
+#define LARG4_STACKINGACTIONBASE_H
+
+#include "artg4tk/actionBase/ActionBase.hh"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "larg4/Services/larg4ActionHolder_service.h"
+
+#include <string>
+
+class G4Track;
+
+namespace larg4 {
+
+  class StackingActionBase : public artg4tk::ActionBase {
+  public:
+    StackingActionBase(std::string myName) : ActionBase(myName)
+    {
+      art::ServiceHandle<larg4ActionHolderService>()->registerAction(this);
+    }
+
+    virtual ~StackingActionBase() = default;
+
+    // Return true to kill the new track before it is stacked
+    virtual bool killNewTrack(const G4Track*) { return false; }
+  };
+
+} // namespace larg4
+
+#endif
@@ -0,0 +1,37 @@
+// larg4::SteppingActionBase is the base class of the stepping actions called
+// through larg4ActionHolderService (see larg4ActionHolder_service.h) rather
+// than artg4tk's ActionHolderService. It mirrors
+// artg4tk::SteppingActionBase, and registers the action with
+// larg4ActionHolderService on construction; only these actions can be
+// restricted to volumes and particles with SteppingSubscriptions.
+
+// Include guard
+#ifndef LARG4_STEPPINGACTIONBASE_H
+#define LARG4_STEPPINGACTIONBASE_H
+
+#include "artg4tk/actionBase/ActionBase.hh"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "larg4/Services/larg4ActionHolder_service.h"
+
+#include <string>
+
+class G4Step;
+
+namespace larg4 {
+
+  class SteppingActionBase : public artg4tk::ActionBase {
+  public:
+    SteppingActionBase(std::string myName) : ActionBase(myName)
+    {
+      art::ServiceHandle<larg4ActionHolderService>()->registerAction(this);
+    }
+
+    virtual ~SteppingActionBase() = default;
+
+    // Called at the end of each step
+    virtual void userSteppingAction(const G4Step*) {}
+  };
+
+} // namespace larg4
+
+#endif
@@ -0,0 +1,37 @@
+// larg4::TrackingActionBase is the base class of the tracking actions called
+// through larg4ActionHolderService (see larg4ActionHolder_service.h) rather
+// than artg4tk's ActionHolderService. It mirrors
+// artg4tk::TrackingActionBase, and registers the action with
+// larg4ActionHolderService on construction.
+
+// Include guard
+#ifndef LARG4_TRACKINGACTIONBASE_H
+#define LARG4_TRACKINGACTIONBASE_H
+
+#include "artg4tk/actionBase/ActionBase.hh"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "larg4/Services/larg4ActionHolder_service.h"
+
+#include <string>
+
+class G4Track;
+
+namespace larg4 {
+
+  class TrackingActionBase : public artg4tk::ActionBase {
+  public:
+    TrackingActionBase(std::string myName) : ActionBase(myName)
+    {
+      art::ServiceHandle<larg4ActionHolderService>()->registerAction(this);
+    }
+
+    virtual ~TrackingActionBase() = default;
+
+    // Called before and after each track is processed
+    virtual void preUserTrackingAction(const G4Track*) {}
+    virtual void postUserTrackingAction(const G4Track*) {}
+  };
+
+} // namespace larg4
+
+#endif
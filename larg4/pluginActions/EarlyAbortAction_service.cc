@@ -0,0 +1,110 @@
+#include "larg4/pluginActions/EarlyAbortAction_service.h"
+#include "cetlib_except/exception.h"
+// Geant4  includes
+#include "Geant4/G4Event.hh"
+#include "Geant4/G4EventManager.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4PrimaryVertex.hh"
+#include "Geant4/G4Run.hh"
+#include "Geant4/G4RunManager.hh"
+#include "Geant4/G4Step.hh"
+#include "Geant4/G4StepPoint.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/G4TrackingManager.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+
+#include <sstream>
+using std::string;
+
+larg4::EarlyAbortActionService::
+EarlyAbortActionService(fhicl::ParameterSet const & p)
+  : artg4tk::RunActionBase(p.get<string>("name", "EarlyAbortActionService") + "RunAction"),
+    artg4tk::EventActionBase(p.get<string>("name", "EarlyAbortActionService") + "EventAction"),
+    larg4::TrackingActionBase(p.get<string>("name", "EarlyAbortActionService") + "TrackingAction"),
+    larg4::SteppingActionBase(p.get<string>("name", "EarlyAbortActionService") + "SteppingAction"),
+  // Initialize our message logger
+  logInfo_("EarlyAbortActionService"),
+  fActiveVolumeNames( p.get<std::vector<string>>("ActiveVolumes", {}) ),
+  fPrimariesLeft(0),
+  fReachedActive(false),
+  fKeepEvent(false),
+  fNEvents(0),
+  fNAborted(0)
+  {
+    if (fActiveVolumeNames.empty()) {
+      throw cet::exception("EarlyAbortActionService") << "Configuration error: ActiveVolumes is empty,"
+                                                      << " every event would be aborted.\n";
+    }
+  }
+
+void larg4::EarlyAbortActionService::beginOfRunAction(const G4Run*) {
+  fActiveVolumes.clear();
+  fNEvents = 0;
+  fNAborted = 0;
+
+  std::stringstream ss;
+  ss << "Events in which no track reaches the following volume(s) will be aborted:";
+  for (auto const& name : fActiveVolumeNames) {
+    G4LogicalVolume const* lv = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!lv) {
+      throw cet::exception("invalidActiveVolumeName")
+        << "Provided active volume name : " << name << " not found!\n";
+    }
+    fActiveVolumes.insert(lv);
+    ss << "\n\t" << name;
+  }
+  logInfo_ << ss.str() << "\n";
+}
+
+void larg4::EarlyAbortActionService::beginOfEventAction(const G4Event* event) {
+  ++fNEvents;
+  fReachedActive = false;
+  fKeepEvent = false;
+  fPrimariesLeft = 0;
+  for (G4int i = 0; i < event->GetNumberOfPrimaryVertex(); ++i) {
+    fPrimariesLeft += event->GetPrimaryVertex(i)->GetNumberOfParticle();
+  }
+}
+
+void larg4::EarlyAbortActionService::userSteppingAction(const G4Step* step) {
+  if (fReachedActive) return;
+
+  if (fActiveVolumes.count(step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume())) {
+    fReachedActive = true;
+    return;
+  }
+  G4VPhysicalVolume const* nextVolume = step->GetPostStepPoint()->GetPhysicalVolume();
+  if (nextVolume && fActiveVolumes.count(nextVolume->GetLogicalVolume())) {
+    fReachedActive = true;
+  }
+}
+
+void larg4::EarlyAbortActionService::postUserTrackingAction(const G4Track* track) {
+  if (fReachedActive || fKeepEvent || track->GetParentID() != 0) return;
+
+  // -- a primary ending anywhere but at the world boundary with secondaries
+  // -- (interaction, decay, ...) may still feed the active volumes
+  bool const leftWorld = (track->GetStep()->GetPostStepPoint()->GetStepStatus() == fWorldBoundary);
+  G4TrackVector const* secondaries = G4EventManager::GetEventManager()->GetTrackingManager()->GimmeSecondaries();
+  if (!leftWorld && secondaries && !secondaries->empty()) {
+    fKeepEvent = true;
+    return;
+  }
+
+  // -- the last primary has left or stopped without anything reaching the active volumes
+  if (--fPrimariesLeft <= 0) {
+    G4RunManager::GetRunManager()->AbortEvent();
+    ++fNAborted;
+  }
+}
+
+void larg4::EarlyAbortActionService::endOfRunAction(const G4Run*) {
+  std::stringstream ss;
+  ss << "Early abort summary: " << fNAborted << " of " << fNEvents
+     << " event(s) aborted with no track reaching the active volume(s).";
+  logInfo_ << ss.str() << "\n";
+}
+
+using larg4::EarlyAbortActionService;
+DEFINE_ART_SERVICE(EarlyAbortActionService)
@@ -0,0 +1,105 @@
+//  EarlyAbortAction is the service that aborts the Geant4 event as soon as
+// all the primary particles have left the world or stopped without any track
+// having reached one of the configured active volumes. It is meant for cosmic
+// and dirt event production, where most events never deposit energy in the
+// TPC and tracking them to completion is wasted time.
+// The event is only aborted if every primary either left the world volume or
+// stopped without producing any secondary: as soon as a primary ends in an
+// interaction or decay, its products could still reach the active volumes and
+// the event is tracked to completion. The secondaries produced along the path
+// of primaries which left the world (e.g. delta rays) are discarded with the
+// aborted event.
+// larg4Main flags aborted events with a bool data product (instance name
+// "aborted") that can be used to filter them out.
+// To use this action, all you need to do is put it in the services section
+// of the configuration file, like this:
+//
+// services: {
+//   ...
+//     EarlyAbortAction: {
+//       service_type: "EarlyAbortActionService"
+//       ActiveVolumes: [ "volTPCActiveInner" ]
+//     }
+//     ...
+// }
+// Expected parameters:
+// - name (string): A name describing the action service.
+//       Default is 'EarlyAbortActionService'
+// - ActiveVolumes (vector<string>): names of the logical volumes that must be
+//       reached for the event to be kept.
+
+
+// Include guard
+#ifndef EARLYABORTACTION_SERVICE_H
+#define EARLYABORTACTION_SERVICE_H
+
+// Includes
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+
+#include "Geant4/globals.hh"
+
+// Get the base classes
+#include "artg4tk/actionBase/EventActionBase.hh"
+#include "artg4tk/actionBase/RunActionBase.hh"
+#include "larg4/actionBase/SteppingActionBase.h"
+#include "larg4/actionBase/TrackingActionBase.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class G4Event;
+class G4LogicalVolume;
+class G4Run;
+class G4Step;
+class G4Track;
+
+namespace larg4 {
+
+  class EarlyAbortActionService : public artg4tk::RunActionBase,
+                                  public artg4tk::EventActionBase,
+                                  public larg4::TrackingActionBase,
+                                  public larg4::SteppingActionBase
+  {
+  public:
+    EarlyAbortActionService(fhicl::ParameterSet const&);
+
+    // Resolve the configured volume names once the geometry exists
+    virtual void beginOfRunAction(const G4Run*) override;
+
+    // Report the number of aborted events
+    virtual void endOfRunAction(const G4Run*) override;
+
+    // Count the primaries of the event
+    virtual void beginOfEventAction(const G4Event*) override;
+
+    // Abort the event when the last primary ends, if all the primaries left
+    // the world or stopped without secondaries
+    virtual void postUserTrackingAction(const G4Track*) override;
+
+    // Look for tracks reaching the active volumes
+    virtual void userSteppingAction(const G4Step*) override;
+
+  private:
+
+    // A message logger for this action object
+    mf::LogInfo logInfo_;
+
+    std::vector<std::string>                   fActiveVolumeNames; ///< configured logical volume names
+    std::unordered_set<G4LogicalVolume const*> fActiveVolumes;     ///< resolved logical volumes
+
+    G4int         fPrimariesLeft;  ///< primaries not yet tracked to the end in this event
+    bool          fReachedActive;  ///< whether a track of this event reached an active volume
+    bool          fKeepEvent;      ///< whether a primary ended producing secondaries in this event
+    unsigned long fNEvents;        ///< events processed in this run
+    unsigned long fNAborted;       ///< events aborted in this run
+  };
+}//namespace larg4
+using larg4::EarlyAbortActionService;
+DECLARE_ART_SERVICE(EarlyAbortActionService,LEGACY)
+
+
+#endif
@@ -0,0 +1,127 @@
+#include "larg4/pluginActions/ImportanceBiasingAction_service.h"
+#include "larg4/Services/LArG4Detector_service.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "cetlib_except/exception.h"
+// Geant4  includes
+#include "Geant4/G4GeometrySampler.hh"
+#include "Geant4/G4IStore.hh"
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4Nsplit_Weight.hh"
+#include "Geant4/G4ParticleDefinition.hh"
+#include "Geant4/G4ParticleTable.hh"
+#include "Geant4/G4VImportanceAlgorithm.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/Randomize.hh"
+
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+  // G4ImportanceAlgorithm, with a limit on the number of copies
+  class ClampedImportanceAlgorithm : public G4VImportanceAlgorithm {
+  public:
+    explicit ClampedImportanceAlgorithm(G4int maxSplit) : fMaxSplit(maxSplit) {}
+
+    G4Nsplit_Weight Calculate(G4double ipre, G4double ipost, G4double init_w) const override {
+      G4Nsplit_Weight nw;
+      nw.fN = 0;
+      nw.fW = 0.;
+      if (!(ipre > 0.) || !(ipost > 0.)) return nw;
+      G4double const ratio = ipost / ipre;
+      if (ratio < 1.) {
+        // -- Russian roulette: survive with probability ratio
+        if (G4UniformRand() < ratio) {
+          nw.fN = 1;
+          nw.fW = init_w / ratio;
+        }
+        return nw;
+      }
+      // -- splitting: on average ratio copies (including the track), each with init_w/ratio
+      nw.fN = static_cast<G4int>(ratio);
+      if (G4UniformRand() < ratio - nw.fN) ++nw.fN;
+      nw.fW = init_w / ratio;
+      if (nw.fN > fMaxSplit) {
+        nw.fN = fMaxSplit;
+        nw.fW = init_w / fMaxSplit;
+      }
+      return nw;
+    }
+
+  private:
+    G4int fMaxSplit;
+  };
+
+}
+
+larg4::ImportanceBiasingActionService::
+ImportanceBiasingActionService(fhicl::ParameterSet const & p)
+  : // Initialize our message logger
+  logInfo_("ImportanceBiasingActionService"),
+  fBiasedParticles( p.get<std::vector<int>>("BiasedParticles", {2112}) ),
+  fMaxSplit( p.get<int>("MaxSplit", 100) )
+  {
+    if (fMaxSplit < 1) {
+      throw cet::exception("ImportanceBiasingActionService") << "Configuration error: MaxSplit"
+                                                             << " must be at least 1, got " << fMaxSplit << "\n";
+    }
+    fAlgorithm = std::make_unique<ClampedImportanceAlgorithm>(fMaxSplit);
+  }
+
+larg4::ImportanceBiasingActionService::~ImportanceBiasingActionService() = default;
+
+void larg4::ImportanceBiasingActionService::configure(G4VPhysicalVolume* world) {
+  if (!fSamplers.empty()) return;
+
+  art::ServiceHandle<LArG4DetectorService const> detector;
+  if (!detector->HasImportances()) {
+    mf::LogWarning("ImportanceBiasingActionService") << "No volume in the geometry has an"
+                                                     << " Importance auxiliary tag, no biasing will be applied.";
+    return;
+  }
+
+  // -- every cell of the geometry needs an importance: one per placement,
+  //    and one per copy of replicated and parameterised volumes
+  G4IStore* istore = G4IStore::GetInstance();
+  std::unordered_set<G4VPhysicalVolume const*> visited;
+  std::vector<G4VPhysicalVolume*> volumes{world};
+  unsigned long nCells = 0;
+  while (!volumes.empty()) {
+    G4VPhysicalVolume* pv = volumes.back();
+    volumes.pop_back();
+    if (!visited.insert(pv).second) continue;
+    G4LogicalVolume* lv = pv->GetLogicalVolume();
+    G4double const importance = detector->GetImportance(lv);
+    if (pv->IsReplicated()) {
+      for (G4int copy = 0; copy < pv->GetMultiplicity(); ++copy) {
+        istore->AddImportanceGeometryCell(importance, *pv, copy);
+        ++nCells;
+      }
+    } else {
+      istore->AddImportanceGeometryCell(importance, *pv, pv->GetCopyNo());
+      ++nCells;
+    }
+    for (size_t i = 0; i < lv->GetNoDaughters(); ++i) volumes.push_back(lv->GetDaughter(i));
+  }
+
+  std::stringstream ss;
+  ss << "Importance biasing of " << nCells << " geometry cells for:";
+  for (int pdg : fBiasedParticles) {
+    G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+    if (!particle) {
+      throw cet::exception("ImportanceBiasingActionService") << "Unknown particle with PDG code " << pdg
+                                                             << " in BiasedParticles.\n";
+    }
+    auto sampler = std::make_unique<G4GeometrySampler>(world, particle->GetParticleName());
+    sampler->SetParallel(false);
+    sampler->PrepareImportanceSampling(istore, fAlgorithm.get());
+    sampler->Configure();
+    fSamplers.push_back(std::move(sampler));
+    ss << "\n\t" << particle->GetParticleName();
+  }
+  ss << "\n(at most " << fMaxSplit << " copies per boundary)";
+  logInfo_ << ss.str() << "\n";
+}
+
+using larg4::ImportanceBiasingActionService;
+DEFINE_ART_SERVICE(ImportanceBiasingActionService)
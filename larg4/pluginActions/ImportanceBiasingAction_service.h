@@ -0,0 +1,101 @@
+//  ImportanceBiasingAction is the service that applies geometry importance
+// biasing (splitting and Russian roulette at volume boundaries) to selected
+// particle species, typically neutrons crossing shielding or overburden.
+// The importance of each logical volume is read from the GDML file, e.g.
+//
+//   <auxiliary auxtype="Importance" auxvalue="8"/>
+//
+// and defaults to 1 for volumes without the tag. The biasing itself is done
+// by Geant4 (G4GeometrySampler and G4ImportanceProcess, in the mass geometry):
+// when a biased track crosses from a volume of importance I1 into a volume of
+// importance I2, it is split into I2/I1 copies (on average) if I2 > I1, or
+// survives with probability I2/I1 if I2 < I1. The track weights are adjusted
+// so that all tallies stay unbiased; they end up in
+// simb::MCParticle::Weight() and scale the energy deposited in the sensitive
+// detectors (but not the numbers of ionization electrons and photons, which
+// describe the deposit of the single track).
+//
+// The copies made by splitting are not separate particles: ParticleListAction
+// folds them into the track they were split from, so that they never appear
+// as daughters in the MCParticle record. Only the MCParticle record is
+// folded: the sensitive detectors (SimEnergyDepositSD, AuxDetSD) store the
+// Geant4 track ID of the copy, which is not in the particle list, so the
+// deposits of split copies cannot be matched to an MCParticle by track ID.
+//
+// To use this action, all you need to do is put it in the services section
+// of the configuration file, like this:
+//
+// services: {
+//   ...
+//     ImportanceBiasingAction: {
+//       service_type: "ImportanceBiasingActionService"
+//       BiasedParticles: [ 2112 ]
+//     }
+//     ...
+// }
+// Expected parameters:
+// - name (string): A name describing the action service.
+//       Default is 'ImportanceBiasingActionService'
+// - BiasedParticles (vector<int>): PDG codes of the biased species.
+//       Default is neutrons only.
+// - MaxSplit (int): maximum number of copies a track is split into at a
+//       single boundary. Default is 100.
+//
+// larg4Main attaches the importance process to the biased particles (see
+// configure()) once the physics list is initialized.
+
+
+// Include guard
+#ifndef IMPORTANCEBIASINGACTION_SERVICE_H
+#define IMPORTANCEBIASINGACTION_SERVICE_H
+
+// Includes
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+
+#include "Geant4/globals.hh"
+
+#include <memory>
+#include <vector>
+
+class G4GeometrySampler;
+class G4VImportanceAlgorithm;
+class G4VPhysicalVolume;
+
+namespace larg4 {
+
+  class ImportanceBiasingActionService
+  {
+  public:
+    ImportanceBiasingActionService(fhicl::ParameterSet const&);
+    ~ImportanceBiasingActionService();
+
+    // Fill the importance store from the geometry and attach the importance
+    // process to the biased particles; only the first call has an effect
+    void configure(G4VPhysicalVolume* world);
+
+    // Name of the Geant4 process creating the split copies (the name
+    // G4ImportanceConfigurator gives to its G4ImportanceProcess)
+    static G4String const& SplitProcessName() {
+      static G4String const name = "ImportanceProcess";
+      return name;
+    }
+
+  private:
+
+    // A message logger for this action object
+    mf::LogInfo logInfo_;
+
+    std::vector<int>                                fBiasedParticles; ///< PDG codes of the biased species
+    G4int                                           fMaxSplit;        ///< maximum number of copies per boundary
+    std::unique_ptr<G4VImportanceAlgorithm>         fAlgorithm;       ///< splitting/roulette with fMaxSplit
+    std::vector<std::unique_ptr<G4GeometrySampler>> fSamplers;        ///< one per biased species
+  };
+}//namespace larg4
+using larg4::ImportanceBiasingActionService;
+DECLARE_ART_SERVICE(ImportanceBiasingActionService,LEGACY)
+
+
+#endif
@@ -0,0 +1,83 @@
+#include "larg4/pluginActions/KillerVolumeAction_service.h"
+#include "cetlib_except/exception.h"
+// Geant4  includes
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4LogicalVolumeStore.hh"
+#include "Geant4/G4ParticleDefinition.hh"
+#include "Geant4/G4Run.hh"
+#include "Geant4/G4Step.hh"
+#include "Geant4/G4StepPoint.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+
+#include <sstream>
+using std::string;
+
+larg4::KillerVolumeActionService::
+KillerVolumeActionService(fhicl::ParameterSet const & p)
+  : artg4tk::RunActionBase(p.get<string>("name", "KillerVolumeActionService") + "RunAction"),
+    larg4::SteppingActionBase(p.get<string>("name", "KillerVolumeActionService") + "SteppingAction"),
+  // Initialize our message logger
+  logInfo_("KillerVolumeActionService"),
+  fKillerVolumeNames( p.get<std::vector<string>>("KillerVolumes", {}) )
+  {
+    if (fKillerVolumeNames.empty()) {
+      mf::LogWarning("KillerVolumeActionService") << "No KillerVolumes configured,"
+                                                  << " this action will not stop any track.";
+    }
+  }
+
+void larg4::KillerVolumeActionService::beginOfRunAction(const G4Run*) {
+  fKillerVolumes.clear();
+  fEscaped.clear();
+
+  std::stringstream ss;
+  ss << "Tracks entering the following volume(s) will be stopped:";
+  for (auto const& name : fKillerVolumeNames) {
+    G4LogicalVolume const* lv = G4LogicalVolumeStore::GetInstance()->GetVolume(name, false);
+    if (!lv) {
+      throw cet::exception("invalidKillerVolumeName")
+        << "Provided killer volume name : " << name << " not found!\n";
+    }
+    if (lv->GetNoDaughters() > 0) {
+      mf::LogWarning("KillerVolumeActionService") << "Killer volume " << name << " has " << lv->GetNoDaughters()
+                                                  << " daughter(s): tracks leaving them into " << name
+                                                  << " are stopped as well.";
+    }
+    fKillerVolumes.insert(lv);
+    ss << "\n\t" << name;
+  }
+  logInfo_ << ss.str() << "\n";
+}
+
+void larg4::KillerVolumeActionService::userSteppingAction(const G4Step* step) {
+  // -- only look at steps ending on a volume boundary
+  G4StepPoint const* postStepPoint = step->GetPostStepPoint();
+  if (postStepPoint->GetStepStatus() != fGeomBoundary) return;
+
+  G4VPhysicalVolume const* nextVolume = postStepPoint->GetPhysicalVolume();
+  if (!nextVolume) return; // -- leaving the world, Geant4 stops the track anyway
+  if (fKillerVolumes.count(nextVolume->GetLogicalVolume()) == 0) return;
+
+  G4Track* track = step->GetTrack();
+  track->SetTrackStatus(fStopAndKill);
+
+  auto& counter = fEscaped[track->GetDefinition()->GetPDGEncoding()];
+  ++counter.nTracks;
+  counter.energy += postStepPoint->GetKineticEnergy();
+}
+
+void larg4::KillerVolumeActionService::endOfRunAction(const G4Run*) {
+  if (fEscaped.empty()) return;
+
+  std::stringstream ss;
+  ss << "Killer volume summary (PDG : tracks stopped, escaped kinetic energy [GeV]):";
+  for (auto const& [pdg, counter] : fEscaped) {
+    ss << "\n\t" << pdg << " : " << counter.nTracks << ", " << counter.energy / CLHEP::GeV;
+  }
+  logInfo_ << ss.str() << "\n";
+}
+
+using larg4::KillerVolumeActionService;
+DEFINE_ART_SERVICE(KillerVolumeActionService)
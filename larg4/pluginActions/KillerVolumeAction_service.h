@@ -0,0 +1,94 @@
+//  KillerVolumeAction is the service that stops every track entering one of
+// a configurable list of logical volumes (typically a dedicated shell of
+// air or rock surrounding the detector hall), so that no time is spent
+// transporting particles that can never come back to the detector.
+// To use this action, all you need to do is put it in the services section
+// of the configuration file, like this:
+//
+// services: {
+//   ...
+//     KillerVolumeAction: {
+//       service_type: "KillerVolumeActionService"
+//       KillerVolumes: [ "volOuterShell" ]
+//     }
+//     ...
+// }
+// Expected parameters:
+// - name (string): A name describing the action service.
+//       Default is 'KillerVolumeActionService'
+// - KillerVolumes (vector<string>): names of the logical volumes in which
+//       tracks are stopped as soon as they cross into them.
+//
+// A track is stopped whenever it steps into the volume itself, including
+// from one of its daughters: a mother of detector volumes (like the world
+// volume TOP of lArDet.gdml, which directly contains the paddles and the
+// calorimeter cells) must not be used, or the tracks travelling between its
+// daughters are lost. A warning is given for killer volumes with daughters.
+//
+// For validation, the number of killed tracks and their kinetic energy at
+// the boundary are accumulated per particle species and reported at the
+// end of the run.
+
+
+// Include guard
+#ifndef KILLERVOLUMEACTION_SERVICE_H
+#define KILLERVOLUMEACTION_SERVICE_H
+
+// Includes
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+
+#include "Geant4/globals.hh"
+
+// Get the base classes
+#include "artg4tk/actionBase/RunActionBase.hh"
+#include "larg4/actionBase/SteppingActionBase.h"
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class G4LogicalVolume;
+class G4Run;
+class G4Step;
+
+namespace larg4 {
+
+  class KillerVolumeActionService : public artg4tk::RunActionBase,
+                                    public larg4::SteppingActionBase
+  {
+  public:
+    KillerVolumeActionService(fhicl::ParameterSet const&);
+
+    // Resolve the configured volume names once the geometry exists
+    virtual void beginOfRunAction(const G4Run*) override;
+
+    // Report the escaped-energy accounting
+    virtual void endOfRunAction(const G4Run*) override;
+
+    // Stop tracks crossing into a killer volume
+    virtual void userSteppingAction(const G4Step*) override;
+
+  private:
+
+    struct EscapeCounter_t {
+      unsigned long nTracks = 0;  ///< number of tracks stopped
+      G4double      energy  = 0.; ///< summed kinetic energy at the boundary [MeV]
+    };
+
+    // A message logger for this action object
+    mf::LogInfo logInfo_;
+
+    std::vector<std::string>                   fKillerVolumeNames; ///< configured logical volume names
+    std::unordered_set<G4LogicalVolume const*> fKillerVolumes;     ///< resolved logical volumes
+    std::map<int, EscapeCounter_t>             fEscaped;           ///< key is the PDG code
+  };
+}//namespace larg4
+using larg4::KillerVolumeActionService;
+DECLARE_ART_SERVICE(KillerVolumeActionService,LEGACY)
+
+
+#endif
@@ -6,6 +6,7 @@
 ////////////////////////////////////////////////////////////////////////
 
 #include "larg4/pluginActions/ParticleListAction_service.h"
+#include "larg4/pluginActions/ImportanceBiasingAction_service.h"
 #include "nug4/G4Base/PrimaryParticleInformation.h"
 #include "lardataobj/Simulation/sim.h"
 #include "nug4/ParticleNavigation/ParticleList.h"
@@ -39,6 +40,7 @@
 
 
 #include <algorithm>
+#include <limits>
 #include <string>
 
 // unused const G4bool debug = false;
@@ -66,8 +68,8 @@ namespace larg4 {
   // Constructor.
   ParticleListActionService::ParticleListActionService(fhicl::ParameterSet const & p)
     : artg4tk::EventActionBase("PLASEventActionBase"),
-      artg4tk::TrackingActionBase("PLASTrackingActionBase"),
-      artg4tk::SteppingActionBase("PLASSteppingActionBase"),
+      larg4::TrackingActionBase("PLASTrackingActionBase"),
+      larg4::SteppingActionBase("PLASSteppingActionBase"),
       // Initialize our message logger
       logInfo_("ParticleListActionService"),
       fenergyCut(p.get<double>("EnergyCut",0.0*CLHEP::GeV)),
@@ -80,7 +82,11 @@ namespace larg4 {
       fSparsifyTrajectories( p.get<bool>("SparsifyTrajectories",false) ),
       fSparsifyMargin( p.get<double>("SparsifyMargin") ),
       fKeepTransportation( p.get<bool>("KeepTransportation", false) ),
-      fKeepSecondToLast( p.get<bool>("KeepSecondToLast", false) )
+      fKeepSecondToLast( p.get<bool>("KeepSecondToLast", false) ),
+      fCompressTrajectories( p.has_key("CompressTrajectories") ),
+      fPositionResolution( p.get<double>("CompressTrajectories.positionResolution", 1.e-3) ),
+      fTimeResolution( p.get<double>("CompressTrajectories.timeResolution", 0.01) ),
+      fMomentumResolution( p.get<double>("CompressTrajectories.momentumResolution", 1.e-4) )
   {
 
     // Create the particle list that we'll (re-)use during the course
@@ -120,6 +126,11 @@ namespace larg4 {
     if (fSparsifyTrajectories) logInfo_ << "Trajectory sparsification enabled with SparsifyMargin : "
                                         << fSparsifyMargin << "\n";
 
+    // -- compressed trajectories
+    if (fCompressTrajectories) logInfo_ << "Trajectories stored compressed with resolutions "
+                                        << fPositionResolution << " cm, " << fTimeResolution << " ns, "
+                                        << fMomentumResolution << " (relative momentum)\n";
+
   }
 
   art::Event  *ParticleListActionService::getCurrArtEvent() { return (currentArtEvent_); }
@@ -315,6 +326,21 @@ namespace larg4 {
       // one of pair production, compton scattering, photoelectric effect
       // bremstrahlung, annihilation, or ionization
       process_name = track->GetCreatorProcess()->GetProcessName();
+
+      // copies made by importance splitting are the continuation of the track
+      // they were split from (with a fraction of its weight), not daughters:
+      // fold them into that track in the particle list (the sensitive detectors
+      // still record the track ID of the copy, which has no MCParticle)
+      if (process_name == ImportanceBiasingActionService::SplitProcessName())
+      {
+        fParentIDMap[trackID] = parentID;
+        fCurrentTrackID = this->GetParentage(trackID);
+        if(!fparticleList->KnownParticle(fCurrentTrackID))
+          fCurrentTrackID = sim::NoParticleId;
+        fCurrentParticle.clear();
+        return;
+      }
+
       if( !fKeepEMShowerDaughters )
       {
         bool notstore = false;
@@ -743,6 +769,7 @@ namespace larg4 {
 
   partCol_ = std::make_unique<std::vector<simb::MCParticle > >();
   tpassn_ = std::make_unique<art::Assns<simb::MCTruth, simb::MCParticle, sim::GeneratedParticleInfo >>();
+  trajCol_ = std::make_unique<std::vector<larg4::CompressedTrajectory > >();
   // Set up the utility class for the "for_each" algorithm.  (We only
   // need a separate set-up for the utility class because we need to
   // give it the pointer to the particle list.  We're using the STL
@@ -797,6 +824,12 @@ namespace larg4 {
               throw error;
             }
 
+            // -- the compressed copy replaces all but the end points of the trajectory
+            if (fCompressTrajectories) {
+              trajCol_->emplace_back(p.TrackId(), p.Trajectory(), p.Trajectory().TrajectoryProcesses(),
+                                     fPositionResolution, fTimeResolution, fMomentumResolution);
+              p.SparsifyTrajectory(std::numeric_limits<double>::max(), false);
+            }
             partCol_->push_back(std::move(p));
             art::Ptr<simb::MCParticle> mcp_ptr = art::Ptr<simb::MCParticle>(pid_,partCol_->size()-1,evt->productGetter(pid_));
             tpassn_->addSingle(mct, mcp_ptr, truthInfo);
@@ -23,10 +23,11 @@
 #include "nusimdata/SimulationBase/simb.h" // simb::GeneratedParticleIndex_t
 // Get the base classes
 #include "artg4tk/actionBase/EventActionBase.hh"
-#include "artg4tk/actionBase/TrackingActionBase.hh"
-#include "artg4tk/actionBase/SteppingActionBase.hh"
+#include "larg4/actionBase/TrackingActionBase.h"
+#include "larg4/actionBase/SteppingActionBase.h"
 
 #include "lardataobj/Simulation/GeneratedParticleInfo.h"
+#include "larg4/DataProducts/CompressedTrajectory.h"
 
 #include "Geant4/globals.hh"
 #include <map>
@@ -43,8 +44,8 @@ namespace sim {
 namespace larg4 {
 
   class ParticleListActionService : public  artg4tk::EventActionBase,
-                                    public  artg4tk::TrackingActionBase,
-                                    public  artg4tk::SteppingActionBase
+                                    public  larg4::TrackingActionBase,
+                                    public  larg4::SteppingActionBase
   {
   public:
 
@@ -128,6 +129,10 @@ namespace larg4 {
     std::unique_ptr <std::vector<simb::MCParticle>>  &GetParticleCollection(){return partCol_;}
     //std::unique_ptr <art::Assns<simb::MCTruth, simb::MCParticle >> &GetAssnsMCTruthToMCParticle(){return tpassn_;}
     std::unique_ptr <art::Assns<simb::MCTruth, simb::MCParticle, sim::GeneratedParticleInfo >> &GetAssnsMCTruthToMCParticle(){return tpassn_;}
+    /// Whether the trajectories are written as a separate, compressed product
+    bool CompressTrajectories() const { return fCompressTrajectories; }
+    /// Compressed trajectories, in the order of the particle collection
+    std::unique_ptr <std::vector<larg4::CompressedTrajectory>> &GetCompressedTrajectories(){return trajCol_;}
   private:
     // A message logger for this action object
     mf::LogInfo logInfo_;
@@ -161,6 +166,10 @@ namespace larg4 {
     double                   fSparsifyMargin;        ///< set the sparsification margin
     bool                     fKeepTransportation;    ///< tell whether or not to keep the transportation process 
     bool                     fKeepSecondToLast;      ///< tell whether or not to force keeping the second to last point 
+    bool                     fCompressTrajectories;  ///< store the trajectories as larg4::CompressedTrajectory
+    double                   fPositionResolution;    ///< compressed trajectory position resolution [cm]
+    double                   fTimeResolution;        ///< compressed trajectory time resolution [ns]
+    double                   fMomentumResolution;    ///< compressed trajectory momentum resolution, relative
 
     std::unique_ptr<thePositionInVolumeFilter> fFilter; ///< filter for particles to be kept
 
@@ -185,6 +194,7 @@ namespace larg4 {
     std::unique_ptr<std::vector<simb::MCParticle> > partCol_;
     //std::unique_ptr<art::Assns<simb::MCTruth, simb::MCParticle >> tpassn_;
     std::unique_ptr<art::Assns<simb::MCTruth, simb::MCParticle, sim::GeneratedParticleInfo >> tpassn_;
+    std::unique_ptr<std::vector<larg4::CompressedTrajectory> > trajCol_;
     art::ProductID pid_;
     /// Adds a trajectory point to the current particle, and runs the filter
     void AddPointToCurrentParticle(TLorentzVector const& pos,
@@ -0,0 +1,96 @@
+#include "larg4/pluginActions/SecondaryThresholdAction_service.h"
+#include "larg4/Services/SimEnergyDepositSD.h"
+#include "cetlib_except/exception.h"
+// Geant4  includes
+#include "Geant4/G4LogicalVolume.hh"
+#include "Geant4/G4ParticleDefinition.hh"
+#include "Geant4/G4Run.hh"
+#include "Geant4/G4Track.hh"
+#include "Geant4/G4VPhysicalVolume.hh"
+#include "Geant4/G4VSensitiveDetector.hh"
+#include "Geant4/G4VTouchable.hh"
+#include "Geant4/G4SystemOfUnits.hh"
+
+#include <sstream>
+#include <vector>
+using std::string;
+
+larg4::SecondaryThresholdActionService::
+SecondaryThresholdActionService(fhicl::ParameterSet const & p)
+  : artg4tk::RunActionBase(p.get<string>("name", "SecondaryThresholdActionService") + "RunAction"),
+    larg4::StackingActionBase(p.get<string>("name", "SecondaryThresholdActionService") + "StackingAction"),
+  // Initialize our message logger
+  logInfo_("SecondaryThresholdActionService"),
+  fOnlyOutsideSensitive( p.get<bool>("OnlyOutsideSensitive", false) ),
+  fDepositLocally( p.get<bool>("DepositLocally", true) )
+  {
+    auto const pdgs = p.get<std::vector<int>>("ThresholdPDGs", {});
+    auto const energies = p.get<std::vector<double>>("ThresholdEnergies", {});
+    if (pdgs.size() != energies.size()) {
+      throw cet::exception("SecondaryThresholdActionService") << "Configuration error: ThresholdPDGs:[] and"
+                                                              << " ThresholdEnergies:[] have different sizes!\n";
+    }
+    std::stringstream ss;
+    ss << "Secondaries below the following kinetic energies will not be tracked:";
+    for (size_t i = 0; i < pdgs.size(); ++i) {
+      if (pdgs[i] == -11) {
+        throw cet::exception("SecondaryThresholdActionService") << "Configuration error: positrons (-11)"
+                                                                << " cannot be in ThresholdPDGs, killing them"
+                                                                << " would lose their annihilation photons.\n";
+      }
+      if (energies[i] < 0.) {
+        throw cet::exception("SecondaryThresholdActionService") << "Invalid threshold for PDG " << pdgs[i]
+                                                                << ": " << energies[i] << " MeV\n";
+      }
+      fThresholds[pdgs[i]] = energies[i] * CLHEP::MeV;
+      ss << "\n\t" << pdgs[i] << " : " << energies[i] << " MeV";
+    }
+    if (fOnlyOutsideSensitive) ss << "\n(only outside the sensitive volumes)";
+    logInfo_ << ss.str() << "\n";
+  }
+
+void larg4::SecondaryThresholdActionService::beginOfRunAction(const G4Run*) {
+  fKilled.clear();
+}
+
+bool larg4::SecondaryThresholdActionService::killNewTrack(const G4Track* track) {
+  if (track->GetParentID() == 0) return false; // -- never touch the primaries
+
+  auto const threshold = fThresholds.find(track->GetDefinition()->GetPDGEncoding());
+  if (threshold == fThresholds.end() || track->GetKineticEnergy() >= threshold->second) return false;
+
+  G4VSensitiveDetector* sd = nullptr;
+  if (G4VTouchable const* touchable = track->GetTouchable(); touchable && touchable->GetVolume()) {
+    sd = touchable->GetVolume()->GetLogicalVolume()->GetSensitiveDetector();
+  }
+  if (sd && fOnlyOutsideSensitive) return false;
+
+  auto& counter = fKilled[track->GetDefinition()->GetPDGEncoding()];
+  ++counter.nTracks;
+  counter.energy += track->GetKineticEnergy();
+  // -- only charged leptons stop close enough to their creation point
+  G4ParticleDefinition const* particle = track->GetDefinition();
+  bool const chargedLepton = particle->GetParticleType() == "lepton" && particle->GetPDGCharge() != 0.;
+  if (fDepositLocally && chargedLepton) {
+    if (auto* edepSD = dynamic_cast<SimEnergyDepositSD*>(sd)) {
+      edepSD->AddLocalDeposit(track);
+      counter.deposited += track->GetKineticEnergy();
+    }
+  }
+  return true;
+}
+
+void larg4::SecondaryThresholdActionService::endOfRunAction(const G4Run*) {
+  if (fKilled.empty()) return;
+
+  std::stringstream ss;
+  ss << "Secondary threshold summary (PDG : tracks killed, kinetic energy, deposited locally [MeV]):";
+  for (auto const& [pdg, counter] : fKilled) {
+    ss << "\n\t" << pdg << " : " << counter.nTracks << ", " << counter.energy / CLHEP::MeV
+       << ", " << counter.deposited / CLHEP::MeV;
+  }
+  logInfo_ << ss.str() << "\n";
+}
+
+using larg4::SecondaryThresholdActionService;
+DEFINE_ART_SERVICE(SecondaryThresholdActionService)
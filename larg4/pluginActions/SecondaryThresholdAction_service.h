@@ -0,0 +1,100 @@
+//  SecondaryThresholdAction is the service that kills new secondary tracks
+// whose kinetic energy is below a threshold depending on the particle
+// species, before Geant4 spends any time tracking them. It complements the
+// EnergyCut of ParticleListAction, which only keeps such particles out of the
+// particle list after they have been fully tracked.
+// To use this action, all you need to do is put it in the services section
+// of the configuration file, like this:
+//
+// services: {
+//   ...
+//     SecondaryThresholdAction: {
+//       service_type: "SecondaryThresholdActionService"
+//       ThresholdPDGs:     [ 11, 22 ]
+//       ThresholdEnergies: [ 0.1, 0.05 ]
+//     }
+//     ...
+// }
+// Expected parameters:
+// - name (string): A name describing the action service.
+//       Default is 'SecondaryThresholdActionService'
+// - ThresholdPDGs (vector<int>): PDG codes of the species to be killed.
+//       Positrons (-11) are refused: killing one would also lose the two
+//       511 keV photons of its annihilation, which Geant4's own production
+//       cuts never do.
+// - ThresholdEnergies (vector<double>): corresponding kinetic energy
+//       thresholds [MeV].
+// - OnlyOutsideSensitive (bool): if true, secondaries created inside a
+//       sensitive volume are never killed. Default is false.
+// - DepositLocally (bool): if true, the kinetic energy of charged leptons
+//       killed inside a SimEnergyDeposit sensitive volume is recorded as a
+//       point-like energy deposit at their creation point, as their range
+//       below the threshold is short. Default is true.
+//       The energy of killed photons is not deposited: a photon is not
+//       absorbed where it is created (a 50 keV photon travels about a
+//       centimetre in liquid argon) and its energy is simply lost, as for
+//       the neutral tracks SimEnergyDepositSD::ProcessHits refuses. Hadrons
+//       and neutrons never deposit their energy either.
+
+
+// Include guard
+#ifndef SECONDARYTHRESHOLDACTION_SERVICE_H
+#define SECONDARYTHRESHOLDACTION_SERVICE_H
+
+// Includes
+#include "fhiclcpp/ParameterSet.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "art/Framework/Services/Registry/ServiceMacros.h"
+
+#include "Geant4/globals.hh"
+
+// Get the base classes
+#include "artg4tk/actionBase/RunActionBase.hh"
+#include "larg4/actionBase/StackingActionBase.h"
+
+#include <map>
+#include <unordered_map>
+
+class G4Run;
+class G4Track;
+
+namespace larg4 {
+
+  class SecondaryThresholdActionService : public artg4tk::RunActionBase,
+                                          public larg4::StackingActionBase
+  {
+  public:
+    SecondaryThresholdActionService(fhicl::ParameterSet const&);
+
+    // Reset the accounting
+    virtual void beginOfRunAction(const G4Run*) override;
+
+    // Report the number and energy of the killed secondaries
+    virtual void endOfRunAction(const G4Run*) override;
+
+    // Kill secondaries below threshold
+    virtual bool killNewTrack(const G4Track*) override;
+
+  private:
+
+    struct KillCounter_t {
+      unsigned long nTracks   = 0;  ///< number of tracks killed
+      G4double      energy    = 0.; ///< summed kinetic energy [MeV]
+      G4double      deposited = 0.; ///< part of it deposited locally [MeV]
+    };
+
+    // A message logger for this action object
+    mf::LogInfo logInfo_;
+
+    std::unordered_map<int, G4double> fThresholds;          ///< key is the PDG code, value in MeV
+    bool                              fOnlyOutsideSensitive;
+    bool                              fDepositLocally;
+    std::map<int, KillCounter_t>      fKilled;              ///< key is the PDG code
+  };
+}//namespace larg4
+using larg4::SecondaryThresholdActionService;
+DECLARE_ART_SERVICE(SecondaryThresholdActionService,LEGACY)
+
+
+#endif